@@ -5,6 +5,7 @@
 #include <cstdint>
 #include <cstring>
 #include <functional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -39,6 +40,11 @@ class Move {
   int piece_id() const noexcept { return m_ >> 11; }
   int orientation() const noexcept { return m_ >> 8 & 0x7; }
 
+  // Returns the 16-bit encoding of the move, and constructs a move from it.
+  // The encoding is stable and is used by game records.
+  uint16_t raw() const noexcept { return m_; }
+  static Move from_raw(uint16_t raw) noexcept { return Move(raw); }
+
   // Returns a four-letter code for the move.
   std::string code() const noexcept;
 
@@ -78,6 +84,7 @@ class BlokusDuoStandard {
   constexpr static int NUM_ORIENTED_PIECES = 91;
   constexpr static int XSIZE = 14;
   constexpr static int YSIZE = 14;
+  constexpr static int NUM_ACTIONS = 13730;
   constexpr static int CHILD_RESERVE = 128;
   constexpr static int START1X = 4;
   constexpr static int START1Y = 4;
@@ -106,6 +113,11 @@ class BlokusDuoStandard {
   };
 
   static const std::array<const Piece*, NUM_ORIENTED_PIECES> piece_set;
+
+  // The first action ID of each oriented piece, indexed by
+  // `piece_id << 3 | orientation`. Entries for non-canonical orientations are
+  // unused.
+  static const uint16_t action_offsets[NUM_PIECES * 8];
 };
 
 // Represents a simplified version of Blokus Duo, with a smaller board (8x8)
@@ -116,6 +128,7 @@ class BlokusDuoMini {
   constexpr static int NUM_ORIENTED_PIECES = 28;
   constexpr static int XSIZE = 8;
   constexpr static int YSIZE = 8;
+  constexpr static int NUM_ACTIONS = 1270;
   constexpr static int CHILD_RESERVE = 32;
   constexpr static int START1X = 2;
   constexpr static int START1Y = 2;
@@ -145,6 +158,11 @@ class BlokusDuoMini {
   };
 
   static const std::array<const Piece*, NUM_ORIENTED_PIECES> piece_set;
+
+  // The first action ID of each oriented piece, indexed by
+  // `piece_id << 3 | orientation`. Entries for non-canonical orientations are
+  // unused.
+  static const uint16_t action_offsets[NUM_PIECES * 8];
 };
 
 // This class encapsulates the state of the game board. It provides methods for
@@ -228,9 +246,78 @@ class BoardImpl {
   // for violet, lower values are better for orange.
   int evaluate() const { return piece_eval_ + eval_influence(); }
 
+  // Computes the anchors of `player` (adding the starting point before their
+  // first move if `seed_start`) and, if not null, the cells they are not
+  // blocked from and the cells they are: those occupied by either player or
+  // sharing an edge with one of their tiles. Rows are in the format of
+  // influence_rows().
+  void open_rows(int player, bool seed_start,
+                 std::array<uint16_t, YSIZE>* anchors,
+                 std::array<uint16_t, YSIZE>* open,
+                 std::array<uint16_t, YSIZE>* blocked = nullptr) const;
+
+  // Returns the cells counted for `player` by the influence term of
+  // evaluate(), as one bitmask per row (bit x of element y is cell (x, y)).
+  std::array<uint16_t, YSIZE> influence_rows(int player) const;
+
+  // Returns the cells that `player` could still cover, in the same format:
+  // the empty cells connected to their anchors (or their starting point)
+  // through cells that do not touch their tiles by an edge, with diagonal
+  // steps allowed. Later moves only shrink this set, so its size bounds the
+  // tiles the player can still place. The flood fill stops early, returning
+  // a subset, once it has reached more than `max_cells` cells or a cell in
+  // `stop`.
+  std::array<uint16_t, YSIZE> reachable_rows(
+      int player, int max_cells = XSIZE * YSIZE,
+      const std::array<uint16_t, YSIZE>& stop = {}) const;
+
   // Same as evaluate(), but higher values are better for the current player.
   int nega_eval() const { return is_violet_turn() ? evaluate() : -evaluate(); }
 
+  // The two terms of nega_eval(): the values of the pieces placed, which cost
+  // nothing to compute, and the influence term, which takes a flood fill.
+  int piece_nega_eval() const {
+    return is_violet_turn() ? piece_eval_ : -piece_eval_;
+  }
+  int influence_nega_eval() const {
+    return is_violet_turn() ? eval_influence() : -eval_influence();
+  }
+
+  // The value that playing `move` adds to the piece term of the player who
+  // plays it; zero for a pass.
+  static int piece_value(Move move);
+
+  // Returns child(move).nega_eval() without constructing the child: the piece
+  // is placed in a copy of this board's rows, which are evaluated directly.
+  int child_nega_eval(Move move) const;
+
+  // The influence of the player not to move, computed once to evaluate many
+  // children of a board.
+  struct InfluenceCache {
+    int count;
+    std::array<uint16_t, YSIZE> rows;
+  };
+  InfluenceCache opponent_influence() const;
+
+  // Same as above. A move only changes the opponent's influence if it covers
+  // some of it, since their flood fill does not cross other cells, so
+  // otherwise it is taken from `cache`, which must be this board's
+  // opponent_influence().
+  int child_nega_eval(Move move, const InfluenceCache& cache) const;
+
+  // Stores child_nega_eval(moves[i]) in values[i] for every move. Like
+  // evaluate_batch(), it evaluates four Mini children per SIMD pass. `values`
+  // must be at least as long as `moves`.
+  void child_nega_evals(std::span<const Move> moves,
+                        std::span<int> values) const;
+
+  // Stores boards[i].evaluate() in values[i] for every board. The boards are
+  // repacked as struct-of-arrays so that several of them (Mini) or both
+  // players of each of them (Standard) share SIMD registers. `values` must be
+  // at least as long as `boards`.
+  static void evaluate_batch(std::span<const BoardImpl> boards,
+                             std::span<int> values);
+
   // Generates a list of all possible moves that could be made in the game
   // (regardless of the current game state, as this method is static).
   static std::vector<Move> all_possible_moves();
@@ -238,6 +325,29 @@ class BoardImpl {
   // Rotate the move around the center of the board.
   static Move rotate_move(Move move, int rotation);
 
+  // Transforms the coordinates of a cell with the same symmetry as
+  // rotate_move().
+  static std::pair<int, int> rotate_point(int x, int y, int rotation);
+
+  // The rotation that reflects the board across its main diagonal. Both
+  // starting points lie on it, so it is the one symmetry that maps every
+  // position to an equivalent one: the same evaluation, and the same moves
+  // transformed with rotate_move().
+  constexpr static int TRANSPOSE = 3;
+
+  // Returns the key of the board reached by the moves of this one transformed
+  // with TRANSPOSE.
+  Key transposed_key() const;
+
+  // Dense action-space indexing. The action ID of a move is its index in
+  // all_possible_moves() after canonicalization, so IDs range from 0 to
+  // NUM_ACTIONS - 1 and the pass move is NUM_ACTIONS - 1. action_id() takes
+  // constant time; action_move() does a binary search over the oriented
+  // pieces.
+  constexpr static int NUM_ACTIONS = Game::NUM_ACTIONS;
+  static int action_id(Move move);
+  static Move action_move(int id);
+
  protected:
   constexpr static uint32_t PASSED = 0x80000000;
   Key key_;
@@ -247,7 +357,9 @@ class BoardImpl {
   int player_ = 0;
 
   bool placeable(int px, int py, const Piece* piece) const noexcept;
-  int eval_influence() const;
+  // Returns the influence term of evaluate(), counting only the players whose
+  // bits are set in `players`.
+  int eval_influence(unsigned players = 3) const;
 };
 
 namespace standard {
@@ -259,13 +371,126 @@ using Board = BoardImpl<BlokusDuoMini>;
 // blokusuduo::Board is an alias for the standard version.
 using Board = BoardImpl<BlokusDuoStandard>;
 
+namespace features {
+
+// Feature planes written by encode(), from the point of view of the player to
+// move ("own") and the other player ("opponent").
+enum Plane {
+  OWN_TILES,
+  OPPONENT_TILES,
+  // Empty cells where the player can start a piece: diagonal neighbors of
+  // their tiles, or their starting point before their first move.
+  OWN_ANCHORS,
+  OPPONENT_ANCHORS,
+  // Cells the player can no longer fill: occupied cells and cells sharing an
+  // edge with one of their tiles.
+  OWN_BLOCKED,
+  OPPONENT_BLOCKED,
+  // Cells counted by the influence term of evaluate().
+  OWN_INFLUENCE,
+  OPPONENT_INFLUENCE,
+  // One constant plane per piece, set to 1 while the player still has the
+  // piece: NUM_PIECES planes for the player to move, then the opponent's.
+  REMAINING_PIECES,
+};
+
+template <class Game>
+constexpr int NUM_PLANES = REMAINING_PIECES + 2 * Game::NUM_PIECES;
+
+// Writes the feature planes of every board to `out` as a C-contiguous
+// (N, NUM_PLANES, YSIZE, XSIZE) tensor of zeros and ones. The planes are
+// transformed with `symmetry` (0-7, as in BoardImpl::rotate_move()); 0 is the
+// identity. `out` must hold at least N * NUM_PLANES * YSIZE * XSIZE values.
+template <class Game>
+void encode(std::span<const BoardImpl<Game>> boards, int symmetry,
+            std::span<float> out);
+
+// Maps a policy target indexed by action ID (see BoardImpl::action_id()) to
+// the board transformed with `symmetry`, so that it matches planes written by
+// encode() with the same symmetry. `policy` and `out` must both hold
+// NUM_ACTIONS values.
+template <class Game>
+void transform_policy(std::span<const float> policy, int symmetry,
+                      std::span<float> out);
+
+}  // namespace features
+
 namespace search {
 // The best move found, and the score of that move.
 using SearchResult = std::pair<Move, short>;
 
-// The number of nodes visited during search. The library does not reset this
-// value, so it accumulates across multiple calls to search functions.
-extern int visited_nodes;
+// The number of nodes visited during search by the calling thread. The library
+// does not reset this value, so it accumulates across multiple calls to search
+// functions.
+extern thread_local int visited_nodes;
+
+template <class Game>
+class LeafEvaluator;  // Defined in blokusduo_evaluator.h.
+
+// Counts of the children at the search horizon that lazy evaluation decided
+// without their influence term; see SearchOptions::lazy_eval_stats.
+struct LazyEvalStats {
+  // Children found unable to raise alpha, or certain to reach beta.
+  long long shortcuts = 0;
+  // Those of them whose full evaluation says otherwise.
+  long long wrong = 0;
+};
+
+// Counts of the enhanced transposition cutoff checks, indexed by the number
+// of plies left at the node; see SearchOptions::etc_stats.
+struct EtcStats {
+  // Nodes whose children were checked.
+  std::vector<long long> nodes;
+  // Those of them that one of their children's table entries cut off.
+  std::vector<long long> cutoffs;
+};
+
+// Options for negascout() and negascout_gumbel().
+template <class Game>
+struct SearchOptions {
+  // If set, positions at the search horizon are evaluated by this evaluator,
+  // one batch per node at the last ply, instead of one nega_eval() call per
+  // position with cutoffs in between. Move ordering still uses nega_eval().
+  LeafEvaluator<Game>* evaluator = nullptr;
+  // Whether to prune with ProbCut, which uses shallow searches to predict
+  // cutoffs. Only the Standard game has ProbCut parameters.
+  bool probcut = true;
+  // Whether to skip the influence term of a child at the horizon when its
+  // piece term alone decides how it compares with the search window. The
+  // child's influence term is assumed to stay within a margin of its
+  // parent's, calibrated on sample searches, so a child outside it can
+  // rarely be misjudged. Not used with `evaluator`.
+  bool lazy_eval = false;
+  // If set, the search adds to these counts, evaluating each child decided
+  // lazily in full to count the wrong decisions. Meant for calibrating the
+  // margin; it costs more than lazy evaluation saves.
+  LazyEvalStats* lazy_eval_stats = nullptr;
+  // Whether a search from a position that is its own transpose (see
+  // BoardImpl::TRANSPOSE), such as the empty board, searches only one of
+  // each pair of transposed moves at the root, and shares transposition
+  // table entries between transposed positions. Other roots are searched as
+  // usual. Not used with Gumbel noise at the root, which is drawn per move.
+  bool symmetry = true;
+  // Late move reductions: at nodes with at least three plies left, each
+  // child after the first `lmr_moves` in move order is first searched one
+  // ply shallower with a null window, and only searched in full if that
+  // fails high. 0 turns them off.
+  int lmr_moves = 0;
+  // Whether to prune with multi-cut: before searching the children of a
+  // null-window node with at least four plies left, the first few are
+  // searched two plies shallower, and if enough of them fail high, so does
+  // the node.
+  bool multi_cut = false;
+  // Whether a node with at least three plies left first looks its children
+  // up in the transposition table, and cuts off without searching any of
+  // them if one is already bounded to fail high (enhanced transposition
+  // cutoff). This does not change the result, but the lookups cost more
+  // than the rare cutoffs save.
+  bool etc = false;
+  // If set, the search adds the enhanced transposition cutoff checks and
+  // cutoffs to these counts.
+  EtcStats* etc_stats = nullptr;
+};
 
 // Performs the NegaScout (Principal Variation Search) algorithm to evaluate
 // the given game board node up to a specified maximum depth.
@@ -274,23 +499,96 @@ extern int visited_nodes;
 // a boolean indicating whether to continue the search.
 template <class Game>
 SearchResult negascout(const BoardImpl<Game>& node, int max_depth,
-                       std::function<bool(int, SearchResult)> callback);
+                       std::function<bool(int, SearchResult)> callback,
+                       const SearchOptions<Game>& options = {});
 
 // Performs NegaScout after adding Gumbel noise to each move at the root.
 // `temperature` is expressed in evaluation-score units. `seed` makes the
 // randomized choice reproducible. The returned score does not include noise.
 template <class Game>
-SearchResult negascout_gumbel(
-    const BoardImpl<Game>& node, int max_depth, double temperature,
-    uint64_t seed, std::function<bool(int, SearchResult)> callback);
+SearchResult negascout_gumbel(const BoardImpl<Game>& node, int max_depth,
+                              double temperature, uint64_t seed,
+                              std::function<bool(int, SearchResult)> callback,
+                              const SearchOptions<Game>& options = {});
+
+// Options for wld() and perfect(). The prunings do not change the results;
+// they can be turned off to measure them.
+struct EndgameOptions {
+  // Whether to cut off nodes whose final score cannot leave the search
+  // window, bounding each player's remaining gain by the tiles of their
+  // unplaced pieces and by the cells they can still reach.
+  bool capacity_bounds = true;
+  // Whether to stop searching turn by turn once neither player can reach a
+  // cell the other can, and instead solve each player's placements on their
+  // own, one king-connected region at a time.
+  bool split_regions = true;
+  // Whether to solve the rest of the game as a single-player search once a
+  // player has passed: from then on, the other one places as many tiles as
+  // they can without interference.
+  bool single_player = true;
+  // If positive, the search gives up once it has run for about this many
+  // seconds, and returns an invalid move.
+  double seconds = 0;
+};
 
 // Performs a win-loss-draw (WLD) search on the given game board node.
 template <class Game>
-SearchResult wld(const BoardImpl<Game>& node);
+SearchResult wld(const BoardImpl<Game>& node,
+                 const EndgameOptions& options = {});
 
 // Returns the optimal move for the given game board node.
 template <class Game>
-SearchResult perfect(const BoardImpl<Game>& node);
+SearchResult perfect(const BoardImpl<Game>& node,
+                     const EndgameOptions& options = {});
+
+// Estimates the number of nodes in the full game tree below `node`, with
+// Knuth's estimator: each of `probes` random playouts to the end of the game
+// estimates it as the sum, over its plies, of the product of the numbers of
+// moves so far, and the estimate is their mean.
+template <class Game>
+double estimate_tree_size(const BoardImpl<Game>& node, int probes,
+                          uint64_t seed);
+
+// The searches auto_search() can choose.
+enum class SearchKind { NEGASCOUT, WLD, PERFECT };
+
+// What auto_search() predicted and did; see AutoSearchOptions::info.
+struct AutoSearchInfo {
+  // The estimate_tree_size() of the position.
+  double tree_size = 0;
+  // The predicted time of wld() and perfect(), in seconds.
+  double wld_seconds = 0;
+  double perfect_seconds = 0;
+  // The search whose result was returned.
+  SearchKind kind = SearchKind::NEGASCOUT;
+  // Whether an endgame search was started but ran out of time.
+  bool fell_back = false;
+};
+
+// Options for auto_search().
+template <class Game>
+struct AutoSearchOptions {
+  // The time to spend on the move. It is a soft limit: the NegaScout
+  // fallback always completes depth 2.
+  double seconds = 1;
+  // The random playouts of estimate_tree_size(), and their seed.
+  int probes = 64;
+  uint64_t seed = 0;
+  // Options for each search.
+  SearchOptions<Game> negascout = {};
+  EndgameOptions endgame = {};
+  // If set, receives the predictions and the choice.
+  AutoSearchInfo* info = nullptr;
+};
+
+// Chooses between perfect(), wld() and iteratively deepened negascout() by
+// the time the endgame searches are predicted to take, from the size of the
+// game tree: the most exact search predicted to fit in half the time is run.
+// An endgame search that does not finish in time is abandoned for the next
+// cheaper one, and NegaScout uses the rest of the time.
+template <class Game>
+SearchResult auto_search(const BoardImpl<Game>& node,
+                         const AutoSearchOptions<Game>& options = {});
 
 template <class Game>
 Move opening_move(const BoardImpl<Game>& b);
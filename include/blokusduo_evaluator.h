@@ -0,0 +1,125 @@
+#ifndef BLOKUSDUO_EVALUATOR_H_
+#define BLOKUSDUO_EVALUATOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "blokusduo.h"
+
+namespace blokusduo::search {
+
+// Evaluates batches of leaf positions for the searches, for example with a
+// neural network. Values are for the player to move, in the units of
+// nega_eval(): ProbCut margins and Gumbel temperatures assume that scale.
+// Implementations must allow concurrent calls from several search threads.
+template <class Game>
+class LeafEvaluator {
+ public:
+  virtual ~LeafEvaluator() = default;
+
+  // Stores the value of boards[i] in values[i]. `values` is as long as
+  // `boards`.
+  virtual void evaluate(std::span<const BoardImpl<Game>> boards,
+                        std::span<int> values) = 0;
+};
+
+// The library's evaluation: nega_eval(), computed with evaluate_batch().
+template <class Game>
+class BuiltinEvaluator : public LeafEvaluator<Game> {
+ public:
+  void evaluate(std::span<const BoardImpl<Game>> boards,
+                std::span<int> values) override;
+};
+
+// Collects the positions passed by concurrent callers into batches of up to
+// `batch_size` positions for another evaluator. A caller waits until its
+// positions have been evaluated; if the batch has not filled `max_latency`
+// after the call, the caller evaluates the positions queued so far instead
+// of waiting for more. Requests larger than `batch_size` are split.
+template <class Game>
+class BatchingEvaluator : public LeafEvaluator<Game> {
+ public:
+  BatchingEvaluator(LeafEvaluator<Game>* backend, int batch_size,
+                    std::chrono::microseconds max_latency);
+
+  void evaluate(std::span<const BoardImpl<Game>> boards,
+                std::span<int> values) override;
+
+  // The number of batches and positions passed to the backend so far.
+  long batches() const;
+  long positions() const;
+
+ private:
+  struct Request {
+    std::span<const BoardImpl<Game>> boards;
+    std::span<int> values;
+    size_t queued = 0;   // Positions not yet taken into a batch.
+    size_t pending = 0;  // Positions not yet evaluated.
+  };
+
+  // Evaluates up to `batch_size_` queued positions. Called and returns with
+  // `lock` held, but releases it while the backend runs.
+  void run_batch(std::unique_lock<std::mutex>& lock);
+
+  LeafEvaluator<Game>* const backend_;
+  const size_t batch_size_;
+  const std::chrono::microseconds max_latency_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable done_;
+  std::deque<Request*> queue_;
+  size_t queued_positions_ = 0;
+  long batches_ = 0;
+  long positions_ = 0;
+};
+
+// Remembers the values another evaluator gave, in a direct-mapped table of
+// 2^`bits` entries indexed by a hash of the position, and passes it only the
+// positions it has no entry for. A position replaces the one in its entry.
+// Each entry packs 32 bits of the hash with the value into one atomic word,
+// so concurrent callers share the table without locks; a position whose
+// hash agrees with a cached one's in the index and those bits, about once in
+// 2^32 lookups, gets the other's value.
+//
+// A search meets the same position through transpositions and again in each
+// iteration of iterative deepening, and consecutive searches of a game
+// overlap. The table pays for evaluators that take longer than its cache
+// misses; BuiltinEvaluator does not.
+template <class Game>
+class CachingEvaluator : public LeafEvaluator<Game> {
+ public:
+  CachingEvaluator(LeafEvaluator<Game>* backend, int bits = 20);
+
+  void evaluate(std::span<const BoardImpl<Game>> boards,
+                std::span<int> values) override;
+
+  // Empties the table and resets the counts below.
+  void clear();
+
+  // The positions looked up so far, and those found in the table.
+  long long lookups() const { return lookups_; }
+  long long hits() const { return hits_; }
+
+ private:
+  static uint64_t hash(const BoardImpl<Game>& board) {
+    return typename BoardImpl<Game>::Key::Hash()(board.key());
+  }
+  // The high half of an entry: never zero, so that empty entries match no
+  // position.
+  static uint64_t check(uint64_t hash) { return hash >> 32 | 1; }
+
+  LeafEvaluator<Game>* const backend_;
+  const uint64_t mask_;
+  std::vector<std::atomic<uint64_t>> entries_;
+  std::atomic<long long> lookups_ = 0;
+  std::atomic<long long> hits_ = 0;
+};
+
+}  // namespace blokusduo::search
+
+#endif  // BLOKUSDUO_EVALUATOR_H_
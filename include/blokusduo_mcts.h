@@ -0,0 +1,82 @@
+#ifndef BLOKUSDUO_MCTS_H_
+#define BLOKUSDUO_MCTS_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "blokusduo.h"
+#include "blokusduo_evaluator.h"
+
+namespace blokusduo::search {
+
+struct MctsOptions {
+  // How leaves are valued. EVALUATION squashes nega_eval() into (-1, 1);
+  // ROLLOUT plays uniformly random moves to the end of the game and scores
+  // a win, draw, or loss as 1, 0, or -1.
+  enum Leaf { EVALUATION, ROLLOUT };
+
+  int threads = 1;
+  Leaf leaf = EVALUATION;
+  // PUCT exploration constant.
+  double exploration = 1.5;
+  // Priors are a softmax over the children's evaluations, with this
+  // temperature in evaluation-score units.
+  double prior_temperature = 8;
+  // Leaf value is tanh(nega_eval() / value_scale).
+  double value_scale = 30;
+  // Number of losses temporarily added to a node while a thread is searching
+  // below it, so that concurrent threads spread over different paths.
+  int virtual_loss = 3;
+  uint64_t seed = 0;
+};
+
+// Monte Carlo Tree Search with PUCT selection over a tree shared by all
+// search threads. Unlike the alpha-beta searches, it keeps its tree between
+// calls: search() grows the tree of the current root, and advance() moves the
+// root to a child while keeping the subtree searched so far.
+template <class Game>
+class Mcts {
+ public:
+  // If `evaluator` is set, it computes the priors and leaf values instead of
+  // nega_eval(), with one call per expansion. Share a BatchingEvaluator
+  // between threads to batch the expansions of all of them.
+  explicit Mcts(const BoardImpl<Game>& root, const MctsOptions& options = {},
+                LeafEvaluator<Game>* evaluator = nullptr);
+  ~Mcts();
+  Mcts(const Mcts&) = delete;
+  Mcts& operator=(const Mcts&) = delete;
+
+  // Runs playouts until `max_playouts` have been added to the tree or
+  // `max_seconds` have elapsed; zero means no limit for either, but at least
+  // one must be set. Returns the most visited root move and its mean value
+  // scaled to [-1000, 1000] for the player to move. Adds the number of
+  // playouts to visited_nodes.
+  SearchResult search(long max_playouts, double max_seconds);
+
+  // Plays `move` on the root, keeping its subtree if it has been expanded.
+  void advance(Move move);
+
+  const BoardImpl<Game>& root() const { return board_; }
+
+  // Returns the number of playouts through the root, including those reused
+  // by advance().
+  long root_visits() const;
+
+  // Returns the visit count of every expanded root move.
+  std::vector<std::pair<Move, int>> root_visit_counts() const;
+
+ private:
+  struct Node;
+  class Worker;
+
+  BoardImpl<Game> board_;
+  MctsOptions options_;
+  LeafEvaluator<Game>* evaluator_;
+  std::unique_ptr<Node> root_;
+};
+
+}  // namespace blokusduo::search
+
+#endif  // BLOKUSDUO_MCTS_H_
@@ -0,0 +1,133 @@
+#ifndef BLOKUSDUO_RECORD_H_
+#define BLOKUSDUO_RECORD_H_
+
+#include <stdio.h>
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "blokusduo.h"
+
+// A compact, append-only binary format for game records.
+//
+// All integers are little-endian. A file starts with a 16-byte header
+// ("BDGR", a 16-bit version, and zero padding) followed by chunks. A chunk is
+// a 16-byte header ("BDCK", the number of games, the chunk size, and the
+// offset of its index), the game records, and the index: one 32-bit offset
+// per game, relative to the chunk start. A game record is a 24-byte header
+// (seed, temperature, number of plies, variant, flags, and final scores)
+// followed by one 16-bit Move::raw() code per ply and, when the flags say so,
+// one 16-bit search value per ply; each array is padded to 8 bytes.
+//
+// Writers only append whole chunks, and readers ignore a truncated trailing
+// chunk, so a file stays readable while it is being written.
+namespace blokusduo::record {
+
+enum class Variant : uint8_t { STANDARD = 0, MINI = 1 };
+
+template <class Game>
+constexpr Variant variant_of =
+    std::is_same_v<Game, BlokusDuoMini> ? Variant::MINI : Variant::STANDARD;
+
+// A game to be written.
+struct GameRecord {
+  Variant variant = Variant::STANDARD;
+  uint64_t seed = 0;
+  float temperature = 0;
+  int score[2] = {};  // Final score of violet and orange.
+  std::vector<Move> moves;
+  // Optional search value of each move, for the player who made it. Leave
+  // empty to omit values; otherwise it must be as long as `moves`.
+  std::vector<int16_t> values;
+};
+
+// Appends games to a record file, buffering them into chunks.
+class Writer {
+ public:
+  // Opens `path` for appending, creating it if necessary, and drops a
+  // truncated chunk at its end. Fails, leaving the file unchanged, if it is
+  // not empty and not a record of this version. Check ok() for errors.
+  explicit Writer(const std::string& path, int games_per_chunk = 256);
+  ~Writer();
+  Writer(const Writer&) = delete;
+  Writer& operator=(const Writer&) = delete;
+
+  bool ok() const { return fp_ != nullptr && !failed_; }
+
+  // Buffers a game, writing the current chunk once it is full.
+  void write(const GameRecord& game);
+
+  // Writes the buffered games as a chunk, even if it is not full.
+  void flush();
+
+ private:
+  FILE* fp_ = nullptr;
+  bool failed_ = false;
+  int games_per_chunk_;
+  std::vector<uint8_t> chunk_;
+  std::vector<uint32_t> offsets_;
+};
+
+// A game in a mapped record file. The spans point into the mapping.
+struct GameView {
+  Variant variant;
+  uint64_t seed;
+  float temperature;
+  int score[2];
+  std::span<const uint16_t> moves;  // Move::raw() codes.
+  std::span<const int16_t> values;  // Empty if the game has no values.
+
+  Move move(size_t ply) const { return Move::from_raw(moves[ply]); }
+};
+
+// Maps a record file into memory and gives random access to its games
+// without copying them.
+class Reader {
+ public:
+  // Maps `path`. Check ok() for errors.
+  explicit Reader(const std::string& path);
+  ~Reader();
+  Reader(const Reader&) = delete;
+  Reader& operator=(const Reader&) = delete;
+
+  bool ok() const { return data_ != nullptr; }
+  size_t size() const { return games_.size(); }
+  GameView game(size_t index) const;
+
+  // The number of positions (plies) in all games, and the index of the first
+  // position of each game, for sampling positions uniformly.
+  uint64_t num_positions() const { return first_positions_.back(); }
+  uint64_t first_position(size_t game) const { return first_positions_[game]; }
+
+  // Returns the game containing the given position and the ply within it.
+  std::pair<size_t, size_t> locate_position(uint64_t position) const;
+
+ private:
+  void release();
+
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+  std::vector<const uint8_t*> games_;
+  std::vector<uint64_t> first_positions_ = {0};
+};
+
+// Calls `f(board, move, ply)` for each position of `game`, with `board` being
+// the position before `move` is played.
+template <class Game, class F>
+void for_each_position(const GameView& game, F&& f) {
+  BoardImpl<Game> board;
+  for (size_t ply = 0; ply < game.moves.size(); ply++) {
+    const Move move = game.move(ply);
+    f(static_cast<const BoardImpl<Game>&>(board), move, ply);
+    board.play_move(move);
+  }
+}
+
+}  // namespace blokusduo::record
+
+#endif  // BLOKUSDUO_RECORD_H_
@@ -6,6 +6,7 @@
 #include <nanobind/stl/vector.h>
 
 #include "blokusduo.h"
+#include "blokusduo_record.h"
 using namespace blokusduo;
 namespace nb = nanobind;
 
@@ -46,16 +47,147 @@ auto occupancy(const BoardImpl<Game>& b) {
       data, {2, Game::YSIZE, Game::XSIZE}, owner);
 }
 
+// Calls `f` with the action ID of each legal move, without creating Python
+// objects.
+template <class Game, class F>
+class ActionIdVisitor : public BoardImpl<Game>::MoveVisitor {
+ public:
+  explicit ActionIdVisitor(F f) : f_(std::move(f)) {}
+  bool visit_move(Move m) override {
+    f_(BoardImpl<Game>::action_id(m));
+    return true;
+  }
+
+ private:
+  F f_;
+};
+
+template <class Game, class F>
+void visit_action_ids(const BoardImpl<Game>& b, F f) {
+  ActionIdVisitor<Game, F> visitor(std::move(f));
+  b.visit_moves(&visitor);
+}
+
+template <class Game>
+auto legal_action_mask(const BoardImpl<Game>& b) {
+  bool* data = new bool[Game::NUM_ACTIONS]();
+  visit_action_ids(b, [data](int id) { data[id] = true; });
+  nb::capsule owner(data,
+                    [](void* p) noexcept { delete[] static_cast<bool*>(p); });
+  return nb::ndarray<nb::numpy, bool, nb::shape<Game::NUM_ACTIONS>>(
+      data, {Game::NUM_ACTIONS}, owner);
+}
+
+// Packs the legal action mask into 64-bit words; action `i` is bit `i % 64`
+// of word `i / 64`.
+template <class Game>
+auto legal_action_bits(const BoardImpl<Game>& b) {
+  constexpr size_t SIZE = (Game::NUM_ACTIONS + 63) / 64;
+  uint64_t* data = new uint64_t[SIZE]();
+  visit_action_ids(b, [data](int id) {
+    data[id / 64] |= uint64_t{1} << (id % 64);
+  });
+  nb::capsule owner(
+      data, [](void* p) noexcept { delete[] static_cast<uint64_t*>(p); });
+  return nb::ndarray<nb::numpy, uint64_t, nb::shape<SIZE>>(data, {SIZE},
+                                                           owner);
+}
+
+template <class Game>
+auto valid_moves_array(const BoardImpl<Game>& b) {
+  auto* ids = new std::vector<uint16_t>();
+  ids->reserve(Game::CHILD_RESERVE);
+  visit_action_ids(b, [ids](int id) { ids->push_back(id); });
+  nb::capsule owner(ids, [](void* p) noexcept {
+    delete static_cast<std::vector<uint16_t>*>(p);
+  });
+  return nb::ndarray<nb::numpy, uint16_t, nb::ndim<1>>(
+      ids->data(), {ids->size()}, owner);
+}
+
+template <class Game>
+auto evaluate_batch(const std::vector<BoardImpl<Game>>& boards) {
+  int* data = new int[boards.size()];
+  BoardImpl<Game>::evaluate_batch(boards, std::span<int>(data, boards.size()));
+  nb::capsule owner(data,
+                    [](void* p) noexcept { delete[] static_cast<int*>(p); });
+  return nb::ndarray<nb::numpy, int, nb::ndim<1>>(data, {boards.size()},
+                                                  owner);
+}
+
+template <class Game>
+void encode_features(
+    const std::vector<BoardImpl<Game>>& boards,
+    nb::ndarray<float, nb::ndim<4>, nb::c_contig, nb::device::cpu> out,
+    int symmetry) {
+  if (out.shape(0) != boards.size() ||
+      out.shape(1) != features::NUM_PLANES<Game> ||
+      out.shape(2) != Game::YSIZE || out.shape(3) != Game::XSIZE)
+    throw nb::value_error(
+        "out must have shape (len(boards), NUM_PLANES, YSIZE, XSIZE)");
+  nb::gil_scoped_release release;
+  features::encode<Game>(boards, symmetry,
+                         std::span<float>(out.data(), out.size()));
+}
+
+template <class Game>
+void transform_policy(
+    nb::ndarray<const float, nb::shape<Game::NUM_ACTIONS>, nb::c_contig,
+                nb::device::cpu>
+        policy,
+    int symmetry,
+    nb::ndarray<float, nb::shape<Game::NUM_ACTIONS>, nb::c_contig,
+                nb::device::cpu>
+        out) {
+  features::transform_policy<Game>(
+      std::span<const float>(policy.data(), policy.size()), symmetry,
+      std::span<float>(out.data(), out.size()));
+}
+
+template <class Game>
+auto replay_features(const record::GameView& game, int symmetry) {
+  constexpr size_t PLANE_SIZE =
+      features::NUM_PLANES<Game> * Game::YSIZE * Game::XSIZE;
+  const size_t plies = game.moves.size();
+  float* data = new float[plies * PLANE_SIZE];
+  {
+    nb::gil_scoped_release release;
+    std::vector<BoardImpl<Game>> boards;
+    boards.reserve(plies);
+    record::for_each_position<Game>(
+        game, [&](const BoardImpl<Game>& b, Move, size_t) {
+          boards.push_back(b);
+        });
+    features::encode<Game>(boards, symmetry,
+                           std::span<float>(data, plies * PLANE_SIZE));
+  }
+  nb::capsule owner(data,
+                    [](void* p) noexcept { delete[] static_cast<float*>(p); });
+  return nb::ndarray<nb::numpy, float, nb::ndim<4>>(
+      data,
+      {plies, size_t{features::NUM_PLANES<Game>}, size_t{Game::YSIZE},
+       size_t{Game::XSIZE}},
+      owner);
+}
+
+record::GameView game_at(const record::Reader& r, size_t index) {
+  if (index >= r.size()) throw nb::index_error();
+  return r.game(index);
+}
+
 template <class Game>
 void define_blokusduo_module(nb::module_&& m) {
   // Addressable constants.
   static const int XSIZE = BoardImpl<Game>::XSIZE;
   static const int YSIZE = BoardImpl<Game>::YSIZE;
+  static const int NUM_ACTIONS = BoardImpl<Game>::NUM_ACTIONS;
 
   m.attr("NUM_PIECES") = Game::NUM_PIECES;
+  m.attr("NUM_PLANES") = features::NUM_PLANES<Game>;
   nb::class_<BoardImpl<Game>>(m, "Board")
       .def_ro_static("XSIZE", &XSIZE)
       .def_ro_static("YSIZE", &YSIZE)
+      .def_ro_static("NUM_ACTIONS", &NUM_ACTIONS)
       .def(nb::init<>())
       .def("clone", [](const BoardImpl<Game>& b) { return b; })
       .def_prop_ro("player", &BoardImpl<Game>::player)
@@ -74,18 +206,41 @@ void define_blokusduo_module(nb::module_&& m) {
       .def("has_tile", &BoardImpl<Game>::has_tile)
       .def("occupancy", &occupancy<Game>)
       .def("valid_moves", &BoardImpl<Game>::valid_moves)
+      .def("valid_moves_array", &valid_moves_array<Game>)
+      .def("legal_action_mask", &legal_action_mask<Game>)
+      .def("legal_action_bits", &legal_action_bits<Game>)
       .def("play_move", &BoardImpl<Game>::play_move)
       .def("child", &BoardImpl<Game>::child)
       .def("__str__", &BoardImpl<Game>::to_string)
       .def("score", &BoardImpl<Game>::score)
       .def("evaluate", &BoardImpl<Game>::evaluate)
+      .def_static("evaluate_batch", &evaluate_batch<Game>)
       .def_static("all_possible_moves", &BoardImpl<Game>::all_possible_moves)
-      .def_static("rotate_move", &BoardImpl<Game>::rotate_move);
-  m.def("search_negascout", &blokusduo::search::negascout<Game>);
+      .def_static("rotate_move", &BoardImpl<Game>::rotate_move)
+      .def_static("action_id", &BoardImpl<Game>::action_id)
+      .def_static("action_move", &BoardImpl<Game>::action_move);
+  m.def("encode_features", &encode_features<Game>, nb::arg("boards"),
+        nb::arg("out"), nb::arg("symmetry") = 0);
+  m.def("transform_policy", &transform_policy<Game>, nb::arg("policy"),
+        nb::arg("symmetry"), nb::arg("out"));
+  using Callback = std::function<bool(int, search::SearchResult)>;
+  m.def("search_negascout",
+        [](const BoardImpl<Game>& b, int max_depth, Callback callback) {
+          return search::negascout(b, max_depth, std::move(callback));
+        });
   m.def("search_negascout_gumbel",
-        &blokusduo::search::negascout_gumbel<Game>);
-  m.def("search_wld", &blokusduo::search::wld<Game>);
-  m.def("search_perfect", &blokusduo::search::perfect<Game>);
+        [](const BoardImpl<Game>& b, int max_depth, double temperature,
+           uint64_t seed, Callback callback) {
+          return search::negascout_gumbel(b, max_depth, temperature, seed,
+                                          std::move(callback));
+        });
+  m.def("search_wld",
+        [](const BoardImpl<Game>& b) { return search::wld(b); });
+  m.def("search_perfect",
+        [](const BoardImpl<Game>& b) { return search::perfect(b); });
+  m.def("search_auto", [](const BoardImpl<Game>& b, double seconds) {
+    return search::auto_search(b, {.seconds = seconds});
+  });
 }
 
 }  // namespace
@@ -102,7 +257,61 @@ NB_MODULE(blokusduo, m) {
       .def_prop_ro("piece", &Move::piece)
       .def_prop_ro("orientation", &Move::orientation)
       .def_prop_ro("is_pass", &Move::is_pass)
-      .def("canonicalize", &Move::canonicalize);
+      .def("canonicalize", &Move::canonicalize)
+      .def_prop_ro("raw", &Move::raw)
+      .def_static("from_raw", &Move::from_raw);
+  nb::class_<record::Reader>(m, "GameRecordReader")
+      .def(
+          "__init__",
+          [](record::Reader* r, const std::string& path) {
+            new (r) record::Reader(path);
+            if (!r->ok()) {
+              r->~Reader();
+              throw nb::value_error(("cannot read " + path).c_str());
+            }
+          },
+          nb::arg("path"))
+      .def("__len__", &record::Reader::size)
+      .def_prop_ro("num_positions", &record::Reader::num_positions)
+      .def("first_position", &record::Reader::first_position)
+      .def("locate_position", &record::Reader::locate_position)
+      .def("info",
+           [](const record::Reader& r, size_t index) {
+             const record::GameView game = game_at(r, index);
+             nb::dict info;
+             info["variant"] =
+                 game.variant == record::Variant::MINI ? "mini" : "standard";
+             info["seed"] = game.seed;
+             info["temperature"] = game.temperature;
+             info["score"] = std::make_pair(game.score[0], game.score[1]);
+             return info;
+           })
+      .def(
+          "moves",
+          [](const record::Reader& r, size_t index) {
+            const record::GameView game = game_at(r, index);
+            return nb::ndarray<nb::numpy, const uint16_t, nb::ndim<1>>(
+                game.moves.data(), {game.moves.size()});
+          },
+          nb::rv_policy::reference_internal)
+      .def(
+          "values",
+          [](const record::Reader& r, size_t index) {
+            const record::GameView game = game_at(r, index);
+            return nb::ndarray<nb::numpy, const int16_t, nb::ndim<1>>(
+                game.values.data(), {game.values.size()});
+          },
+          nb::rv_policy::reference_internal)
+      .def(
+          "features",
+          [](const record::Reader& r, size_t index, int symmetry) {
+            const record::GameView game = game_at(r, index);
+            if (game.variant == record::Variant::MINI)
+              return nb::cast(replay_features<BlokusDuoMini>(game, symmetry));
+            return nb::cast(
+                replay_features<BlokusDuoStandard>(game, symmetry));
+          },
+          nb::arg("index"), nb::arg("symmetry") = 0);
   define_blokusduo_module<BlokusDuoMini>(m.def_submodule("mini"));
   define_blokusduo_module<BlokusDuoStandard>(m.def_submodule("standard"));
 }
@@ -1,3 +1,6 @@
+import os
+import struct
+import tempfile
 import unittest
 
 import numpy as np
@@ -36,6 +39,71 @@ class BoardTest(unittest.TestCase):
                 game.NUM_PIECES - 1, board.available_pieces()[0].sum()
             )
 
+    def test_action_arrays_match_valid_moves(self):
+        for game in (blokusduo.mini, blokusduo.standard):
+            board = game.Board()
+            for _ in range(3):
+                moves = board.valid_moves()
+                expected = [game.Board.action_id(m) for m in moves]
+
+                ids = board.valid_moves_array()
+                self.assertEqual(np.uint16, ids.dtype)
+                self.assertEqual(expected, ids.tolist())
+                self.assertEqual(
+                    [m.canonicalize() for m in moves],
+                    [game.Board.action_move(i) for i in expected],
+                )
+
+                mask = board.legal_action_mask()
+                self.assertEqual((game.Board.NUM_ACTIONS,), mask.shape)
+                self.assertEqual(
+                    sorted(expected), np.flatnonzero(mask).tolist()
+                )
+
+                bits = np.unpackbits(
+                    board.legal_action_bits().view(np.uint8), bitorder="little"
+                )
+                self.assertTrue(
+                    (bits[: game.Board.NUM_ACTIONS] == mask).all()
+                )
+                board.play_move(moves[0])
+
+    def test_encode_features_fills_the_given_buffer(self):
+        for game in (blokusduo.mini, blokusduo.standard):
+            boards = [game.Board()]
+            for _ in range(4):
+                boards.append(boards[-1].child(boards[-1].valid_moves()[0]))
+            shape = (
+                len(boards),
+                game.NUM_PLANES,
+                game.Board.YSIZE,
+                game.Board.XSIZE,
+            )
+            out = np.full(shape, -1, dtype=np.float32)
+            game.encode_features(boards, out)
+            for board, planes in zip(boards, out):
+                occupancy = board.occupancy()
+                self.assertTrue(
+                    (planes[0] == occupancy[board.player]).all()
+                )
+                self.assertTrue(
+                    (planes[1] == occupancy[board.opponent]).all()
+                )
+
+            policy = np.arange(game.Board.NUM_ACTIONS, dtype=np.float32)
+            transformed = np.empty_like(policy)
+            game.transform_policy(policy, 3, transformed)
+            self.assertEqual(sorted(policy), sorted(transformed))
+
+    def test_evaluate_batch_matches_evaluate(self):
+        for game in (blokusduo.mini, blokusduo.standard):
+            boards = [game.Board()]
+            while not boards[-1].is_game_over():
+                boards.append(boards[-1].child(boards[-1].valid_moves()[-1]))
+            values = game.Board.evaluate_batch(boards)
+            self.assertEqual((len(boards),), values.shape)
+            self.assertEqual([b.evaluate() for b in boards], values.tolist())
+
     def test_gumbel_search_is_reproducible(self):
         board = blokusduo.mini.Board()
         callback = lambda depth, result: True
@@ -50,6 +118,85 @@ class BoardTest(unittest.TestCase):
         )
         self.assertTrue(board.is_valid_move(result[0]))
 
+    def test_auto_search_solves_late_positions(self):
+        board = blokusduo.mini.Board()
+        while board.turn < 8 and not board.is_game_over():
+            board.play_move(board.valid_moves()[0])
+        move, value = blokusduo.mini.search_auto(board, 1.0)
+        self.assertTrue(board.is_valid_move(move))
+        self.assertEqual(blokusduo.mini.search_perfect(board)[1], value)
+
+
+def write_record_file(path, games):
+    """Writes (moves, values, score) tuples of Mini games as one chunk."""
+    pad = lambda data: data + b"\0" * (-len(data) % 8)
+    body = b""
+    offsets = []
+    for moves, values, score in games:
+        offsets.append(16 + len(body))
+        body += struct.pack(
+            "<QfHBB2B6x", 42, 0.5, len(moves), 1, 1, *score
+        )
+        body += pad(struct.pack(f"<{len(moves)}H", *(m.raw for m in moves)))
+        body += pad(struct.pack(f"<{len(values)}h", *values))
+    index = struct.pack(f"<{len(offsets)}I", *offsets)
+    chunk_size = 16 + len(body) + len(index)
+    with open(path, "wb") as f:
+        f.write(b"BDGR" + struct.pack("<H10x", 1))
+        f.write(
+            b"BDCK"
+            + struct.pack("<3I", len(games), chunk_size, 16 + len(body))
+        )
+        f.write(body + index)
+
+
+class GameRecordReaderTest(unittest.TestCase):
+    def test_reads_moves_values_and_features(self):
+        games = []
+        for first in range(2):
+            board = blokusduo.mini.Board()
+            moves = []
+            while not board.is_game_over():
+                moves.append(board.valid_moves()[first if not moves else 0])
+                board.play_move(moves[-1])
+            values = list(range(len(moves)))
+            games.append((moves, values, (board.score(0), board.score(1))))
+
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "games.bdgr")
+            write_record_file(path, games)
+            reader = blokusduo.GameRecordReader(path)
+            self.assertEqual(2, len(reader))
+            self.assertEqual(
+                sum(len(moves) for moves, _, _ in games), reader.num_positions
+            )
+            for i, (moves, values, score) in enumerate(games):
+                info = reader.info(i)
+                self.assertEqual("mini", info["variant"])
+                self.assertEqual(42, info["seed"])
+                self.assertEqual(score, info["score"])
+                self.assertEqual(
+                    moves,
+                    [blokusduo.Move.from_raw(m) for m in reader.moves(i)],
+                )
+                self.assertEqual(values, reader.values(i).tolist())
+                self.assertFalse(reader.moves(i).flags.writeable)
+
+                planes = reader.features(i)
+                board = blokusduo.mini.Board()
+                for ply, move in enumerate(moves):
+                    occupancy = board.occupancy()
+                    self.assertTrue(
+                        (planes[ply, 0] == occupancy[board.player]).all()
+                    )
+                    board.play_move(move)
+            with self.assertRaises(IndexError):
+                reader.moves(2)
+            del reader
+
+            with self.assertRaises(ValueError):
+                blokusduo.GameRecordReader(os.path.join(tmp, "missing.bdgr"))
+
 
 if __name__ == "__main__":
     unittest.main()
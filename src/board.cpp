@@ -2,16 +2,18 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <bit>
-
-#if defined(__AVX2__)
-#include <immintrin.h>
-#elif defined(__ARM_NEON) || defined(__wasm_simd128__)
-#include <arm_neon.h>
-#endif
+#include <iterator>
+#include <type_traits>
+#include <utility>
 
 #include "blokusduo.h"
+#include "kernels.h"
+#include "move_list.h"
+#include "move_visitors.h"
 #include "piece.h"
+#include "piece_data.h"
 
 namespace blokusduo {
 namespace {
@@ -21,37 +23,201 @@ constexpr int PIECE_EVAL_VALUES[] = {
     16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
 };
 
-struct DiagPoint {
-  int x, y, orientation;
-};
+// Calls f(y, cells) for each row y covered by the piece of `move`, which must
+// not be a pass, with the covered cells of the row as a bitmask.
+template <class F>
+void for_each_piece_row(Move move, F f) {
+  const auto& rot = block_set[move.piece_id()].rotations[move.orientation()];
+  const Piece* piece = rot.piece;
+  const int piece_x = move.x() + rot.offset_x + piece->minx;
+  const int piece_y = move.y() + rot.offset_y + piece->miny;
+  const uint8_t* rows = piece_row_masks[piece->id];
+  for (int row = 0; row <= piece->maxy - piece->miny; row++)
+    f(piece_y + row, static_cast<uint16_t>(rows[row] << piece_x));
+}
 
+// The cells that `player` may cover with their next piece, and the anchors it
+// must cover one of, in the 16-row layout of Kernels::placements(). An anchor
+// is a corner neighbor of their tiles; which of its edge neighbors are
+// blocked selects the piece corners that can cover it. There are none before
+// the player's first move, whose starting point visit_moves() handles apart.
 template <class Game>
-class MoveCollector : public BoardImpl<Game>::MoveVisitor {
- public:
-  bool visit_move(Move m) override {
-    moves.push_back(m);
-    return true;
+struct PlacementRows {
+  constexpr static int YSIZE = Game::YSIZE;
+  constexpr static uint16_t ROW_MASK = (uint16_t{1} << Game::XSIZE) - 1;
+
+  PlacementRows(const typename Game::Key& key, int player) {
+    uint16_t own_rows[YSIZE];
+    uint16_t edge_rows[YSIZE];
+    for (int y = 0; y < YSIZE; y++) {
+      own_rows[y] = key.a[player][y] & ROW_MASK;
+    }
+    for (int y = 0; y < YSIZE; y++) {
+      edge_rows[y] = ((own_rows[y] << 1) | (own_rows[y] >> 1) |
+                      vertical(own_rows, y)) &
+                     ROW_MASK;
+    }
+    for (int y = 0; y < YSIZE; y++) {
+      const uint16_t blocked =
+          own_rows[y] | edge_rows[y] | (key.a[1 - player][y] & ROW_MASK);
+      const uint16_t corners = diagonal(own_rows, y);
+      open[y] = ~blocked & ROW_MASK;
+      anchors[y] = corners & ~blocked;
+      const uint16_t top_edge = y > 0 ? edge_rows[y - 1] : 0;
+      const uint16_t left_edge = edge_rows[y] << 1;
+      anchors_by_corner[0][y] = anchors[y] & top_edge & left_edge;
+      anchors_by_corner[1][y] = anchors[y] & top_edge & ~left_edge;
+      anchors_by_corner[2][y] = anchors[y] & ~top_edge & left_edge;
+      anchors_by_corner[3][y] = anchors[y] & ~top_edge & ~left_edge;
+    }
   }
-  std::vector<Move> moves;
+
+  // The cells of row y that share an edge with a cell of `rows` in the rows
+  // above and below it.
+  static uint16_t vertical(const uint16_t (&rows)[YSIZE], int y) {
+    return (y > 0 ? rows[y - 1] : 0) | (y + 1 < YSIZE ? rows[y + 1] : 0);
+  }
+
+  // The cells of row y that are corner neighbors of a cell of `rows`.
+  static uint16_t diagonal(const uint16_t (&rows)[YSIZE], int y) {
+    const uint16_t v = vertical(rows, y);
+    return ((v << 1) | (v >> 1)) & ROW_MASK;
+  }
+
+  // Returns the key that visit_moves() orders the placements of `piece` by,
+  // with its origin at (x, y): the first anchor that one of its corners
+  // covers, in a row-major scan trying each anchor's corners in turn. Returns
+  // UINT32_MAX if it covers none. Inlined so that visit_moves() can fold in
+  // the corners of each piece.
+  [[gnu::always_inline]] uint32_t first_anchor(const Piece& piece, int x,
+                                               int y) const {
+    uint32_t first = UINT32_MAX;
+    for (int corner = 0; corner < 4; corner++) {
+      // A fixed number of corners, so that a piece that is not a constant
+      // does not cost a branch either.
+      for (int i = 0; i < 3; i++) {
+        const int anchor_x = x + piece.corners[corner][i].x;
+        const int anchor_y = y + piece.corners[corner][i].y;
+        // All ones unless the anchor is there, without a branch.
+        const uint32_t missing =
+            ((anchors_by_corner[corner][anchor_y] >> anchor_x & 1) - 1) |
+            (i < piece.nr_corners[corner] ? 0 : UINT32_MAX);
+        first =
+            std::min(first, ((anchor_y * 16 + anchor_x) * 4 + i) | missing);
+      }
+    }
+    return first;
+  }
+
+  alignas(32) uint16_t open[16] = {};
+  alignas(32) uint16_t anchors[16] = {};
+  uint16_t anchors_by_corner[4][YSIZE];
 };
 
-constexpr uint64_t shu8x8(uint64_t bits) { return bits << 8; }
-constexpr uint64_t shd8x8(uint64_t bits) { return bits >> 8; }
+// Calls f.template operator()<Index>() for each oriented piece of Game, by its
+// index in oriented_pieces, until it returns false. Each piece gets its own
+// instantiation, in which its bounding box and corners are constants.
+template <class Game, class F>
+bool for_each_oriented_piece(const F& f) {
+  // Game::piece_set is the tail of oriented_pieces.
+  constexpr int FIRST_PIECE =
+      std::size(oriented_pieces) - Game::NUM_ORIENTED_PIECES;
+  return [&]<int... I>(std::integer_sequence<int, I...>) {
+    return (f.template operator()<FIRST_PIECE + I>() && ...);
+  }(std::make_integer_sequence<int, Game::NUM_ORIENTED_PIECES>());
+}
 
-constexpr uint64_t shl8x8(uint64_t bits) {
-  constexpr uint64_t mask =
-      0b01111111'01111111'01111111'01111111'01111111'01111111'01111111'01111111;
-  return (bits & mask) << 1;
+// Calls f(first, x, y) for each placement of oriented_pieces[index] that fits
+// in `rows.open` and covers one of `anchors`, but none of `skip` if it is not
+// null: its origin, and the first_anchor() key to order it by. Inlined so
+// that a constant index makes the piece's shape constant too.
+template <class Game, class F>
+[[gnu::always_inline]] inline void for_each_placement(
+    const PlacementRows<Game>& rows, int index, const uint16_t* anchors,
+    const uint16_t* skip, F f) {
+  const Piece& piece = oriented_pieces[index];
+  const int height = piece.maxy - piece.miny + 1;
+  const uint8_t* piece_rows = oriented_piece_rows[index];
+  alignas(32) uint16_t valid[16];
+  if (!kernels().placements(rows.open, anchors, piece_rows, height, valid))
+    return;
+  for (int word = 0; word < 4; word++) {
+    uint64_t bits;
+    memcpy(&bits, valid + word * 4, sizeof(bits));
+    for (; bits != 0; bits &= bits - 1) {
+      const int position = word * 64 + std::countr_zero(bits);
+      if (skip) {
+        uint16_t covered = 0;
+        for (int row = 0; row < height; row++) {
+          covered |=
+              skip[position / 16 + row] & (piece_rows[row] << position % 16);
+        }
+        if (covered) continue;
+      }
+      const int x = position % 16 - piece.minx;
+      const int y = position / 16 - piece.miny;
+      const uint32_t first = rows.first_anchor(piece, x, y);
+      if (first != UINT32_MAX) f(first, x, y);
+    }
+  }
+}
+
+// Makes a MoveList entry for the placement of oriented_pieces[index]
+// with its origin at (x, y).
+template <class Entry>
+Entry make_entry(int index, uint32_t first, int x, int y) {
+  const Piece& piece = oriented_pieces[index];
+  const int piece_x = x + piece.minx;
+  const int piece_y = y + piece.miny;
+  Entry entry;
+  entry.key = index << 24 | first << 8 | piece_y;
+  entry.move = Move(x, y, piece.id).raw();
+  for (int row = 0; row < 5; row++)
+    entry.rows[row] = oriented_piece_rows[index][row] << piece_x;
+  return entry;
 }
 
-constexpr uint64_t shr8x8(uint64_t bits) {
-  constexpr uint64_t mask =
-      0b01111111'01111111'01111111'01111111'01111111'01111111'01111111'01111111;
-  return (bits >> 1) & mask;
+// Returns whether the placement of a MoveList entry covers a cell of `cells`,
+// which must extend four rows below the board.
+template <class Entry, class Row>
+bool covers(const Entry& entry, const Row* cells) {
+  const Row* top = cells + (entry.key & 0xff);
+  return ((top[0] & entry.rows[0]) | (top[1] & entry.rows[1]) |
+          (top[2] & entry.rows[2]) | (top[3] & entry.rows[3]) |
+          (top[4] & entry.rows[4])) != 0;
 }
 
-constexpr uint64_t inflate8x8(uint64_t bits) {
-  return bits | shu8x8(bits) | shd8x8(bits) | shl8x8(bits) | shr8x8(bits);
+// Adds a MoveList entry to `entries`, which are sorted by key. The entries
+// are mostly made in order, so this shifts few of them.
+template <class Entry>
+void insert_entry(std::vector<Entry>* entries, const Entry& entry) {
+  entries->push_back(entry);
+  auto it = entries->end() - 1;
+  for (; it != entries->begin() && (it - 1)->key > entry.key; --it)
+    *it = *(it - 1);
+  *it = entry;
+}
+
+// Adds to `entries` the MoveList entries of the placements of the available
+// pieces of `player` that cover one of `anchors` but none of `skip`. Unlike
+// visit_moves(), this shares one loop between the pieces: it is mostly run
+// for the few anchors of a new piece, with few placements.
+template <class Entry, class Game>
+void add_entries(const BoardImpl<Game>& board, int player,
+                 const PlacementRows<Game>& rows, const uint16_t* anchors,
+                 const uint16_t* skip, std::vector<Entry>* entries) {
+  constexpr int FIRST_PIECE =
+      std::size(oriented_pieces) - Game::NUM_ORIENTED_PIECES;
+  for (int index = FIRST_PIECE; index < std::ssize(oriented_pieces);
+       index++) {
+    if (!board.is_piece_available(player, oriented_pieces[index].block_id()))
+      continue;
+    for_each_placement(rows, index, anchors, skip,
+                       [&](uint32_t first, int x, int y) {
+                         insert_entry(entries,
+                                      make_entry<Entry>(index, first, x, y));
+                       });
+  }
 }
 
 int hex_to_int(char c) {
@@ -215,93 +381,139 @@ bool BoardImpl<Game>::visit_moves(MoveVisitor* visitor) const {
     return true;
   }
 
-  // Generate corner candidates and test placements with packed board rows.
-  constexpr uint16_t ROW_MASK = (uint16_t{1} << XSIZE) - 1;
-  // Padding keeps four-row loads within the array at the bottom edge.
-  uint16_t blocked_rows[YSIZE + 3] = {};
-  uint16_t edge_rows[YSIZE];
-  uint16_t own_rows[YSIZE];
-  for (int y = 0; y < YSIZE; y++) {
-    own_rows[y] = key_.a[player_][y] & ROW_MASK;
-  }
+  // Find where each piece fits on the packed board rows, then visit those
+  // placements in the order of the corner anchors they cover.
+  const PlacementRows<Game> rows(key_, player_);
+
+  int nmove = 0;
+  const bool completed = for_each_oriented_piece<Game>([&]<int Index>() {
+    constexpr const Piece& piece = oriented_pieces[Index];
+    if (!is_piece_available(player_, piece.block_id())) return true;
+    if (!visitor->filter(piece.block_id() + 'a', piece.orientation(), *this))
+      return true;
+
+    // Order the placements as a row-major scan of the anchors would reach
+    // them, trying at each anchor the piece's corners that can cover it:
+    // by the first anchor and corner index, packed above the position.
+    uint32_t found[YSIZE * XSIZE];
+    int nfound = 0;
+    for_each_placement(
+        rows, Index, rows.anchors, nullptr, [&](uint32_t first, int x, int y) {
+          const uint32_t entry = first << 8 | x << 4 | y;
+          int j = nfound++;
+          for (; j > 0 && found[j - 1] > entry; j--) found[j] = found[j - 1];
+          found[j] = entry;
+        });
+    for (int i = 0; i < nfound; i++) {
+      if (!visitor->visit_move(Move(found[i] >> 4 & 15, found[i] & 15,
+                                    piece.id)))
+        return false;
+    }
+    nmove += nfound;
+    return true;
+  });
+  if (!completed) return false;
+  if (nmove == 0) return visitor->visit_move(Move::pass());
+
+  return true;
+}
+
+template <class Game>
+MoveList<Game>::MoveList(const Board& board, int player) : player_(player) {
+  const PlacementRows<Game> rows(board.key(), player);
+  entries_.reserve(Game::CHILD_RESERVE);
+  add_entries(board, player, rows, rows.anchors, nullptr, &entries_);
+}
+
+template <class Game>
+void MoveList<Game>::play_move(const Board& board, Move move) {
+  if (move.is_pass()) return;
+  using Rows = PlacementRows<Game>;
+  constexpr int YSIZE = Game::YSIZE;
+  typename Game::Key key_before = board.key();
+  for_each_piece_row(move, [&](int y, uint16_t cells) {
+    key_before.a[player_][y] &= ~cells;
+  });
+  const Rows before(key_before, player_);
+  const Rows rows(board.key(), player_);
+
+  // The placements covering an anchor that was there before the move were
+  // already listed. Those covering a new anchor, or one whose corners
+  // changed with the edges of the new tiles, may have a new key.
+  alignas(32) uint16_t new_anchors[16] = {};
+  uint16_t old_anchors[16] = {};
+  uint16_t changed[YSIZE + 4] = {};
+  uint16_t blocked[YSIZE + 4] = {};
   for (int y = 0; y < YSIZE; y++) {
-    const uint16_t vertical =
-        (y > 0 ? own_rows[y - 1] : 0) |
-        (y + 1 < YSIZE ? own_rows[y + 1] : 0);
-    edge_rows[y] =
-        ((own_rows[y] << 1) | (own_rows[y] >> 1) | vertical) & ROW_MASK;
-    blocked_rows[y] =
-        own_rows[y] | edge_rows[y] | (key_.a[opponent()][y] & ROW_MASK);
+    new_anchors[y] = rows.anchors[y] & ~before.anchors[y];
+    old_anchors[y] = rows.anchors[y] & before.anchors[y];
+    for (int corner = 0; corner < 4; corner++) {
+      changed[y] |= rows.anchors_by_corner[corner][y] ^
+                    before.anchors_by_corner[corner][y];
+    }
+    changed[y] &= rows.anchors[y];
+    blocked[y] = ~rows.open[y] & Rows::ROW_MASK;
   }
 
-  DiagPoint diag_neighbors[100], *diag_point = diag_neighbors;
-  for (int y = 0; y < YSIZE; y++) {
-    const uint16_t vertical =
-        (y > 0 ? own_rows[y - 1] : 0) |
-        (y + 1 < YSIZE ? own_rows[y + 1] : 0);
-    uint16_t corners =
-        ((vertical << 1) | (vertical >> 1)) & ~blocked_rows[y] & ROW_MASK;
-    while (corners != 0) {
-      const int x = std::countr_zero(corners);
-      const uint16_t point = uint16_t{1} << x;
-      const bool top_edge = y > 0 && (edge_rows[y - 1] & point);
-      const bool left_edge = x > 0 && (edge_rows[y] & (point >> 1));
-      diag_point->x = x;
-      diag_point->y = y;
-      diag_point->orientation =
-          top_edge ? (left_edge ? 0 : 1) : (left_edge ? 2 : 3);
-      diag_point++;
-      corners &= corners - 1;
+  // Keep the unblocked placements of the remaining pieces, moving aside
+  // those to be keyed again. The rest stay in order.
+  std::vector<Entry> moved;
+  size_t n = 0;
+  for (const Entry& entry : entries_) {
+    const Move m = Move::from_raw(entry.move);
+    if (m.piece_id() == move.piece_id() || covers(entry, blocked)) continue;
+    if (covers(entry, changed)) {
+      const int index = entry.key >> 24;
+      Entry rekeyed = entry;
+      rekeyed.key = index << 24 |
+                    rows.first_anchor(oriented_pieces[index], m.x(), m.y())
+                        << 8 |
+                    (entry.key & 0xff);
+      insert_entry(&moved, rekeyed);
+    } else {
+      entries_[n++] = entry;
     }
   }
-  diag_point->x = -1;
+  add_entries(board, player_, rows, new_anchors, old_anchors, &moved);
+
+  // Merge them back from the end.
+  entries_.resize(n + moved.size());
+  auto kept = entries_.begin() + n;
+  auto out = entries_.end();
+  for (auto it = moved.end(); it != moved.begin();) {
+    if (kept != entries_.begin() && (kept - 1)->key > (it - 1)->key)
+      *--out = *--kept;
+    else
+      *--out = *--it;
+  }
+}
 
+template <class Game>
+bool MoveList<Game>::visit_moves(const Board& board,
+                                 typename Board::MoveVisitor* visitor) const {
+  // The opponent may have blocked some of the placements since the list
+  // was made.
+  constexpr int YSIZE = Game::YSIZE;
+  uint16_t opponent_rows[YSIZE + 4] = {};
+  for (int y = 0; y < YSIZE; y++) {
+    opponent_rows[y] =
+        board.key().a[1 - player_][y] & PlacementRows<Game>::ROW_MASK;
+  }
   int nmove = 0;
-  for (const Piece* piece : Game::piece_set) {
-    if (!is_piece_available(player_, piece->block_id())) continue;
-    if (!visitor->filter(piece->block_id() + 'a', piece->orientation(), *this))
-      continue;
-    const int min_x = -piece->minx;
-    const int max_x = XSIZE - 1 - piece->maxx;
-    const int min_y = -piece->miny;
-    const int max_y = YSIZE - 1 - piece->maxy;
-    uint16_t checked[YSIZE] = {};
-    const uint8_t* rows = piece_row_masks[piece->id];
-    const uint64_t first_four_rows =
-        uint64_t{rows[0]} | (uint64_t{rows[1]} << 16) |
-        (uint64_t{rows[2]} << 32) | (uint64_t{rows[3]} << 48);
-    for (diag_point = diag_neighbors; diag_point->x >= 0; diag_point++) {
-      const int orientation = diag_point->orientation;
-      for (int i = 0; i < piece->nr_corners[orientation]; i++) {
-        const int x = diag_point->x - piece->corners[orientation][i].x;
-        const int y = diag_point->y - piece->corners[orientation][i].y;
-        if (static_cast<unsigned>(x - min_x) >
-                static_cast<unsigned>(max_x - min_x) ||
-            static_cast<unsigned>(y - min_y) >
-                static_cast<unsigned>(max_y - min_y) ||
-            (checked[y] & (uint16_t{1} << x)))
-          continue;
-        checked[y] |= uint16_t{1} << x;
-
-        const int piece_x = x + piece->minx;
-        const int piece_y = y + piece->miny;
-        // Four 16-bit lanes cover every piece except the five-high bar.
-        uint64_t first_four_blocked;
-        memcpy(&first_four_blocked, blocked_rows + piece_y,
-               sizeof(first_four_blocked));
-        const bool placeable =
-            (first_four_blocked & (first_four_rows << piece_x)) == 0 &&
-            (rows[4] == 0 ||
-             (blocked_rows[piece_y + 4] & (rows[4] << piece_x)) == 0);
-        if (placeable) {
-          if (!visitor->visit_move(Move(x, y, piece->id))) return false;
-          nmove++;
-        }
-      }
+  int index = -1;
+  bool allowed = false;
+  for (const Entry& entry : entries_) {
+    if (static_cast<int>(entry.key >> 24) != index) {
+      index = entry.key >> 24;
+      const Piece& piece = oriented_pieces[index];
+      allowed =
+          visitor->filter(piece.block_id() + 'a', piece.orientation(), board);
     }
+    if (!allowed || covers(entry, opponent_rows)) continue;
+    nmove++;
+    if (!visitor->visit_move(Move::from_raw(entry.move))) return false;
   }
   if (nmove == 0) return visitor->visit_move(Move::pass());
-
   return true;
 }
 
@@ -324,363 +536,268 @@ std::string BoardImpl<Game>::to_string() const {
 
 template <class Game>
 int BoardImpl<Game>::score(int player) const noexcept {
+  // Count the tiles directly; the bits above XSIZE hold other state.
+  constexpr unsigned ROW_MASK = (1u << XSIZE) - 1;
   int score = 0;
-
-  for (int i = 0; i < NUM_PIECES; i++) {
-    if (!is_piece_available(player, i)) score += block_set[i].size;
-  }
+  for (int y = 0; y < YSIZE; y++)
+    score += std::popcount(key_.a[player][y] & ROW_MASK);
   return score;
 }
 
 template <>
-int BoardImpl<BlokusDuoMini>::eval_influence() const {
-  uint64_t vtile = *reinterpret_cast<const uint64_t*>(key_.a[0]);
-  uint64_t otile = *reinterpret_cast<const uint64_t*>(key_.a[1]);
-  uint64_t vmask = ~(inflate8x8(vtile) | otile);
-  uint64_t omask = ~(inflate8x8(otile) | vtile);
-  uint64_t vinfl = (shu8x8(shl8x8(vtile)) | shd8x8(shl8x8(vtile)) |
-                    shu8x8(shr8x8(vtile)) | shd8x8(shr8x8(vtile))) &
-                   vmask;
-  uint64_t oinfl = (shu8x8(shl8x8(otile)) | shd8x8(shl8x8(otile)) |
-                    shu8x8(shr8x8(otile)) | shd8x8(shr8x8(otile))) &
-                   omask;
-  vinfl = inflate8x8(vinfl) & vmask;
-  vinfl = inflate8x8(vinfl) & vmask;
-  oinfl = inflate8x8(oinfl) & omask;
-  oinfl = inflate8x8(oinfl) & omask;
-  return std::popcount(vinfl) - std::popcount(oinfl);
-}
-
-// Estimates each player's influence over open cells. For each player, first
-// exclude occupied cells and cells sharing an edge with one of their tiles,
-// then seed every unblocked diagonal neighbor (or the starting point before
-// the first move). Influence consists of those seeds and all cells reachable
-// from them through unblocked orthogonal moves in at most three steps. The
-// returned value is violet's count minus orange's count.
-//
-// Every implementation below follows that algorithm with a different packed
-// board representation. The neighbor helpers perform bit-parallel shifts in
-// the x and y directions; the main loop builds the blocked set and runs the
-// three expansion steps.
-template <>
-int BoardImpl<BlokusDuoStandard>::eval_influence() const {
-#if defined(__AVX2__)
-  // Pack all 14 rows into one 256-bit register. Each 64-bit lane holds four
-  // 16-bit row slots: 14 board bits followed by two zero padding bits. Shifts
-  // by one move horizontally, shifts by 16 move vertically within a lane, and
-  // 64-bit lane permutations carry rows across lane boundaries. The last
-  // 64-bit lane contains only rows 12 and 13.
-  constexpr uint64_t FOUR_ROWS = 0x3fff3fff3fff3fff;
-  const __m256i board_mask = _mm256_set_epi64x(
-      0x000000003fff3fff, FOUR_ROWS, FOUR_ROWS, FOUR_ROWS);
-  const __m256i no_low_word =
-      _mm256_set_epi64x(-1, -1, -1, 0);
-  const __m256i no_high_word =
-      _mm256_set_epi64x(0, -1, -1, -1);
-
-  const auto vertical_neighbors = [&](const __m256i bits) {
-    const __m256i previous_words = _mm256_and_si256(
-        _mm256_permute4x64_epi64(bits, _MM_SHUFFLE(2, 1, 0, 0)),
-        no_low_word);
-    const __m256i next_words = _mm256_and_si256(
-        _mm256_permute4x64_epi64(bits, _MM_SHUFFLE(3, 3, 2, 1)),
-        no_high_word);
-    return _mm256_or_si256(
-        _mm256_or_si256(_mm256_srli_epi64(bits, 16),
-                        _mm256_slli_epi64(bits, 16)),
-        _mm256_or_si256(_mm256_srli_epi64(previous_words, 48),
-                        _mm256_slli_epi64(next_words, 48)));
-  };
-  const auto orthogonal_neighbors = [&](const __m256i bits) {
-    return _mm256_and_si256(
-        _mm256_or_si256(
-            vertical_neighbors(bits),
-            _mm256_or_si256(_mm256_slli_epi64(bits, 1),
-                            _mm256_srli_epi64(bits, 1))),
-        board_mask);
-  };
-  const auto diagonal_neighbors = [&](const __m256i bits) {
-    const __m256i vertical = vertical_neighbors(bits);
-    return _mm256_and_si256(
-        _mm256_or_si256(_mm256_slli_epi64(vertical, 1),
-                        _mm256_srli_epi64(vertical, 1)),
-        board_mask);
-  };
+int BoardImpl<BlokusDuoMini>::eval_influence(unsigned players) const {
+  uint64_t tiles[2];
+  memcpy(&tiles[0], key_.a[0], sizeof(uint64_t));
+  memcpy(&tiles[1], key_.a[1], sizeof(uint64_t));
+  return kernels().mini_influence(tiles, players);
+}
 
-  __m256i tiles[2];
-  for (int player = 0; player < 2; player++) {
-    // Loading rows 6-13 lets the shift zero-pad the upper lane.
-    const __m128i first_eight = _mm_loadu_si128(
-        reinterpret_cast<const __m128i*>(key_.a[player]));
-    const __m128i last_eight = _mm_loadu_si128(
-        reinterpret_cast<const __m128i*>(key_.a[player] + 6));
-    const __m128i last_six = _mm_srli_si128(last_eight, 4);
-    tiles[player] = _mm256_and_si256(
-        _mm256_inserti128_si256(_mm256_castsi128_si256(first_eight),
-                                last_six, 1),
-        board_mask);
-  }
-
-  int influence[2] = {};
-  for (int player = 0; player < 2; player++) {
-    const __m256i edge = orthogonal_neighbors(tiles[player]);
-    __m256i corner = diagonal_neighbors(tiles[player]);
-    if (_mm256_testz_si256(tiles[player], tiles[player])) {
-      const __m256i start =
-          player == 0
-              ? _mm256_set_epi64x(0, 0, uint64_t{1} << 4, 0)
-              : _mm256_set_epi64x(0, uint64_t{1} << 25, 0, 0);
-      corner = _mm256_or_si256(corner, start);
+template <>
+void BoardImpl<BlokusDuoMini>::evaluate_batch(std::span<const BoardImpl> boards,
+                                              std::span<int> values) {
+  const auto mini_influence_x4 = kernels().mini_influence_x4;
+  size_t i = 0;
+  for (; mini_influence_x4 && i + 4 <= boards.size(); i += 4) {
+    uint64_t packed[2][4];
+    for (int lane = 0; lane < 4; lane++) {
+      memcpy(&packed[0][lane], boards[i + lane].key_.a[0], sizeof(uint64_t));
+      memcpy(&packed[1][lane], boards[i + lane].key_.a[1], sizeof(uint64_t));
     }
+    int64_t influence[4];
+    mini_influence_x4(packed, influence);
+    for (int lane = 0; lane < 4; lane++)
+      values[i + lane] = boards[i + lane].piece_eval_ + influence[lane];
+  }
+  for (; i < boards.size(); i++) values[i] = boards[i].evaluate();
+}
 
-    const __m256i blocked_without_corner = _mm256_or_si256(
-        _mm256_or_si256(tiles[player], edge), tiles[1 - player]);
-    const __m256i blocked =
-        _mm256_or_si256(blocked_without_corner, corner);
-    __m256i frontier =
-        _mm256_andnot_si256(blocked_without_corner, corner);
-    __m256i reached = frontier;
-    const __m256i traversable = _mm256_andnot_si256(blocked, board_mask);
-
-    for (int distance = 0; distance < 3; distance++) {
-      const __m256i adjacent = orthogonal_neighbors(frontier);
-      frontier = _mm256_andnot_si256(
-          reached, _mm256_and_si256(adjacent, traversable));
-      reached = _mm256_or_si256(reached, frontier);
-    }
+namespace {
 
-#if defined(__AVX512VPOPCNTDQ__) && defined(__AVX512VL__)
-    // Use vector popcount when the AVX-512 extension is available for 256-bit
-    // registers; otherwise store the four words and count them scalarly.
-    const __m256i counts = _mm256_popcnt_epi64(reached);
-    const __m128i pair_sums =
-        _mm_add_epi64(_mm256_castsi256_si128(counts),
-                      _mm256_extracti128_si256(counts, 1));
-    influence[player] =
-        _mm_cvtsi128_si64(pair_sums) + _mm_extract_epi64(pair_sums, 1);
-#else
-    alignas(32) uint64_t words[4];
-    _mm256_store_si256(reinterpret_cast<__m256i*>(words), reached);
-    for (uint64_t word : words) influence[player] += std::popcount(word);
-#endif
-  }
-  return influence[0] - influence[1];
-#elif defined(__ARM_NEON) || defined(__wasm_simd128__)
-  // Each 16-bit lane represents one 14-bit board row, so rows 0-7 occupy
-  // `low` and rows 8-13 occupy the first six lanes of `high`; its last two
-  // lanes are masked out. Per-lane bit shifts move horizontally, while vextq
-  // shifts whole rows and carries them between the two registers. Emscripten
-  // maps these 128-bit NEON intrinsics to WebAssembly SIMD.
-  struct SimdRows {
-    uint16x8_t low;
-    uint16x8_t high;
-  };
+// A copy of a board's tiles in the layout of its influence kernel, in which
+// pieces can be placed to evaluate a child without constructing it.
+template <class Game>
+struct PackedTiles;
 
-  const uint16x8_t zeros = vdupq_n_u16(0);
-  uint16x8_t high_mask = vdupq_n_u16(0x3fff);
-  high_mask = vsetq_lane_u16(0, high_mask, 6);
-  high_mask = vsetq_lane_u16(0, high_mask, 7);
-  const SimdRows board_mask = {
-      vdupq_n_u16(0x3fff),
-      high_mask};
-
-  const auto vertical_neighbors = [zeros](const SimdRows& rows) {
-    const uint16x8_t previous_low = vextq_u16(zeros, rows.low, 7);
-    const uint16x8_t next_low = vextq_u16(rows.low, rows.high, 1);
-    const uint16x8_t previous_high = vextq_u16(rows.low, rows.high, 7);
-    const uint16x8_t next_high = vextq_u16(rows.high, zeros, 1);
-    return SimdRows{vorrq_u16(previous_low, next_low),
-                    vorrq_u16(previous_high, next_high)};
-  };
-  const auto orthogonal_neighbors =
-      [&board_mask, &vertical_neighbors](const SimdRows& rows) {
-        const SimdRows vertical = vertical_neighbors(rows);
-        return SimdRows{
-            vandq_u16(
-                vorrq_u16(vertical.low,
-                          vorrq_u16(vshlq_n_u16(rows.low, 1),
-                                    vshrq_n_u16(rows.low, 1))),
-                board_mask.low),
-            vandq_u16(
-                vorrq_u16(vertical.high,
-                          vorrq_u16(vshlq_n_u16(rows.high, 1),
-                                    vshrq_n_u16(rows.high, 1))),
-                board_mask.high)};
-      };
-  const auto diagonal_neighbors =
-      [&board_mask, &vertical_neighbors](const SimdRows& rows) {
-        const SimdRows vertical = vertical_neighbors(rows);
-        return SimdRows{
-            vandq_u16(
-                vorrq_u16(vshlq_n_u16(vertical.low, 1),
-                          vshrq_n_u16(vertical.low, 1)),
-                board_mask.low),
-            vandq_u16(
-                vorrq_u16(vshlq_n_u16(vertical.high, 1),
-                          vshrq_n_u16(vertical.high, 1)),
-                board_mask.high)};
-      };
-
-  SimdRows tiles[2];
-  for (int player = 0; player < 2; player++) {
-    const uint16x8_t first_eight = vld1q_u16(key_.a[player]);
-    // Start at row 6 so the load stays within the 14-row array, then discard
-    // its first two rows and shift zeros into the unused positions.
-    const uint16x8_t last_eight = vld1q_u16(key_.a[player] + 6);
-    const uint16x8_t last_six = vextq_u16(last_eight, zeros, 2);
-    tiles[player] = {
-        vandq_u16(first_eight, board_mask.low),
-        vandq_u16(last_six, board_mask.high)};
+template <>
+struct PackedTiles<BlokusDuoMini> {
+  explicit PackedTiles(const BlokusDuoMini::Key& key) {
+    memcpy(&tiles[0], key.a[0], sizeof(uint64_t));
+    memcpy(&tiles[1], key.a[1], sizeof(uint64_t));
+  }
+  // Adds the piece of `move`, which must not be a pass.
+  void place(int player, Move move) {
+    for_each_piece_row(move, [this, player](int y, uint16_t cells) {
+      tiles[player] |= uint64_t{cells} << (y * 8);
+    });
+  }
+  int influence(unsigned players) const {
+    return kernels().mini_influence(tiles, players);
   }
 
-  int influence[2] = {};
-  for (int player = 0; player < 2; player++) {
-    const SimdRows edge = orthogonal_neighbors(tiles[player]);
-    SimdRows corner = diagonal_neighbors(tiles[player]);
-    const uint64x2_t tile_words =
-        vreinterpretq_u64_u16(vorrq_u16(tiles[player].low,
-                                        tiles[player].high));
-    if ((vgetq_lane_u64(tile_words, 0) |
-         vgetq_lane_u64(tile_words, 1)) == 0) {
-      if (player == 0) {
-        corner.low = vsetq_lane_u16(
-            vgetq_lane_u16(corner.low, 4) | (uint16_t{1} << 4),
-            corner.low, 4);
-      } else {
-        corner.high = vsetq_lane_u16(
-            vgetq_lane_u16(corner.high, 1) | (uint16_t{1} << 9),
-            corner.high, 1);
-      }
-    }
+  uint64_t tiles[2];
+};
 
-    const SimdRows blocked_without_corner = {
-        vorrq_u16(vorrq_u16(tiles[player].low, edge.low),
-                  tiles[1 - player].low),
-        vorrq_u16(vorrq_u16(tiles[player].high, edge.high),
-                  tiles[1 - player].high)};
-    const SimdRows blocked = {
-        vorrq_u16(blocked_without_corner.low, corner.low),
-        vorrq_u16(blocked_without_corner.high, corner.high)};
-    SimdRows frontier = {
-        vbicq_u16(corner.low, blocked_without_corner.low),
-        vbicq_u16(corner.high, blocked_without_corner.high)};
-    SimdRows reached = frontier;
-    const SimdRows traversable = {
-        vbicq_u16(board_mask.low, blocked.low),
-        vbicq_u16(board_mask.high, blocked.high)};
-
-    for (int distance = 0; distance < 3; distance++) {
-      const SimdRows adjacent = orthogonal_neighbors(frontier);
-      frontier = {
-          vbicq_u16(vandq_u16(adjacent.low, traversable.low), reached.low),
-          vbicq_u16(vandq_u16(adjacent.high, traversable.high), reached.high)};
-      reached = {vorrq_u16(reached.low, frontier.low),
-                 vorrq_u16(reached.high, frontier.high)};
-    }
+template <>
+struct PackedTiles<BlokusDuoStandard> {
+  explicit PackedTiles(const BlokusDuoStandard::Key& key) {
+    memcpy(rows, key.a, sizeof(rows));
+  }
+  void place(int player, Move move) {
+    for_each_piece_row(move, [this, player](int y, uint16_t cells) {
+      rows[player][y] |= cells;
+    });
+  }
+  int influence(unsigned players) const {
+    return kernels().standard_influence(rows, players);
+  }
 
-    // Emscripten's NEON compatibility implementation scalarizes vcntq_u8.
-    // Clang's elementwise popcount builtin lowers to the same native NEON
-    // instruction and directly to i8x16.popcnt in WebAssembly.
-#if defined(__clang__)
-    const uint8x16_t byte_counts = vaddq_u8(
-        __builtin_elementwise_popcount(
-            vreinterpretq_u8_u16(reached.low)),
-        __builtin_elementwise_popcount(
-            vreinterpretq_u8_u16(reached.high)));
-#else
-    const uint8x16_t byte_counts = vaddq_u8(
-        vcntq_u8(vreinterpretq_u8_u16(reached.low)),
-        vcntq_u8(vreinterpretq_u8_u16(reached.high)));
-#endif
-    const uint16x8_t pair_counts = vpaddlq_u8(byte_counts);
-    const uint32x4_t quad_counts = vpaddlq_u16(pair_counts);
-    const uint64x2_t half_counts = vpaddlq_u32(quad_counts);
-    influence[player] = vgetq_lane_u64(half_counts, 0) +
-                        vgetq_lane_u64(half_counts, 1);
-  }
-  return influence[0] - influence[1];
-#else
-  // Use the same four-word packing as the AVX2 branch, but operate on scalar
-  // 64-bit values. Each word holds four 16-bit row slots with two padding bits
-  // per row; explicit neighboring-word terms carry vertical shifts across
-  // word boundaries.
-  using Bits = std::array<uint64_t, 4>;
-  constexpr uint64_t FOUR_ROWS = 0x3fff3fff3fff3fff;
-  constexpr Bits BOARD_MASK = {
-      FOUR_ROWS, FOUR_ROWS, FOUR_ROWS, 0x000000003fff3fff};
-
-  const auto orthogonal_neighbors = [&BOARD_MASK](const Bits& bits) {
-    Bits result;
-    for (int word = 0; word < 4; word++) {
-      const uint64_t vertical =
-          (bits[word] >> 16) | (bits[word] << 16) |
-          (word > 0 ? bits[word - 1] >> 48 : 0) |
-          (word < 3 ? bits[word + 1] << 48 : 0);
-      result[word] =
-          ((bits[word] << 1) | (bits[word] >> 1) | vertical) &
-          BOARD_MASK[word];
-    }
-    return result;
-  };
-  const auto diagonal_neighbors = [&BOARD_MASK](const Bits& bits) {
-    Bits result;
-    for (int word = 0; word < 4; word++) {
-      const uint64_t vertical =
-          (bits[word] >> 16) | (bits[word] << 16) |
-          (word > 0 ? bits[word - 1] >> 48 : 0) |
-          (word < 3 ? bits[word + 1] << 48 : 0);
-      result[word] = ((vertical << 1) | (vertical >> 1)) & BOARD_MASK[word];
-    }
-    return result;
+  uint16_t rows[2][BlokusDuoStandard::YSIZE];
+};
+
+}  // namespace
+
+template <>
+int BoardImpl<BlokusDuoStandard>::eval_influence(unsigned players) const {
+  return kernels().standard_influence(key_.a, players);
+}
+
+// eval_influence() already runs both players' flood fills side by side, so
+// a Standard batch only saves the per-call overhead.
+template <>
+void BoardImpl<BlokusDuoStandard>::evaluate_batch(
+    std::span<const BoardImpl> boards, std::span<int> values) {
+  for (size_t i = 0; i < boards.size(); i++)
+    values[i] = boards[i].piece_eval_ + boards[i].eval_influence();
+}
+
+// A row-by-row version of the eval_influence() algorithms that keeps the
+// reached cells instead of counting them. Like the Mini kernel, the Mini
+// board expands two steps and does not seed the starting point.
+template <class Game>
+std::array<uint16_t, BoardImpl<Game>::YSIZE> BoardImpl<Game>::influence_rows(
+    int player) const {
+  constexpr bool IS_STANDARD = std::is_same_v<Game, BlokusDuoStandard>;
+  constexpr int DISTANCE = IS_STANDARD ? 3 : 2;
+  const auto vertical = [](const std::array<uint16_t, YSIZE>& rows, int y) {
+    return (y > 0 ? rows[y - 1] : 0) | (y + 1 < YSIZE ? rows[y + 1] : 0);
   };
 
-  Bits tiles[2] = {};
-  for (int player = 0; player < 2; player++) {
+  std::array<uint16_t, YSIZE> traversable, frontier, reached;
+  open_rows(player, IS_STANDARD, &frontier, &traversable);
+  for (int y = 0; y < YSIZE; y++) {
+    reached[y] = frontier[y];
+    traversable[y] &= ~frontier[y];
+  }
+  for (int distance = 0; distance < DISTANCE; distance++) {
+    const std::array<uint16_t, YSIZE> previous = frontier;
     for (int y = 0; y < YSIZE; y++) {
-      tiles[player][y / 4] |=
-          static_cast<uint64_t>(key_.a[player][y] & 0x3fff) << (y % 4 * 16);
+      const uint16_t adjacent =
+          (previous[y] << 1) | (previous[y] >> 1) | vertical(previous, y);
+      frontier[y] = adjacent & traversable[y] & ~reached[y];
+      reached[y] |= frontier[y];
     }
   }
+  return reached;
+}
 
-  int influence[2] = {};
-  for (int player = 0; player < 2; player++) {
-    Bits edge = orthogonal_neighbors(tiles[player]);
-    Bits corner = diagonal_neighbors(tiles[player]);
-    bool has_tiles = false;
-    for (uint64_t word : tiles[player]) has_tiles |= word != 0;
-    if (!has_tiles) {
-      const int x = player == 0 ? BlokusDuoStandard::START1X
-                                : BlokusDuoStandard::START2X;
-      const int y = player == 0 ? BlokusDuoStandard::START1Y
-                                : BlokusDuoStandard::START2Y;
-      corner[y / 4] |= uint64_t{1} << (y % 4 * 16 + x);
-    }
+template <class Game>
+typename BoardImpl<Game>::InfluenceCache BoardImpl<Game>::opponent_influence()
+    const {
+  InfluenceCache cache = {0, influence_rows(opponent())};
+  for (uint16_t row : cache.rows) cache.count += std::popcount(row);
+  return cache;
+}
 
-    Bits traversable;
-    Bits reached;
-    Bits frontier;
-    for (int word = 0; word < 4; word++) {
-      const uint64_t blocked =
-          tiles[player][word] | edge[word] | corner[word] |
-          tiles[1 - player][word];
-      frontier[word] =
-          corner[word] &
-          ~(tiles[player][word] | edge[word] | tiles[1 - player][word]);
-      reached[word] = frontier[word];
-      traversable[word] = ~blocked & BOARD_MASK[word];
+template <class Game>
+int BoardImpl<Game>::piece_value(Move move) {
+  return move.is_pass() ? 0 : PIECE_EVAL_VALUES[move.piece_id()];
+}
+
+template <class Game>
+int BoardImpl<Game>::child_nega_eval(Move move) const {
+  // The child's player to move is this board's opponent.
+  if (move.is_pass()) return -nega_eval();
+  PackedTiles<Game> tiles(key_);
+  tiles.place(player_, move);
+  const int value =
+      piece_eval_ +
+      (player_ == 0 ? 1 : -1) * PIECE_EVAL_VALUES[move.piece_id()] +
+      tiles.influence(3);
+  return player_ == 0 ? -value : value;
+}
+
+template <class Game>
+int BoardImpl<Game>::child_nega_eval(Move move,
+                                     const InfluenceCache& cache) const {
+  if (move.is_pass()) return -nega_eval();
+  bool covers_cache = false;
+  for_each_piece_row(move, [&](int y, uint16_t cells) {
+    covers_cache |= (cells & cache.rows[y]) != 0;
+  });
+  PackedTiles<Game> tiles(key_);
+  tiles.place(player_, move);
+  int value = piece_eval_ +
+              (player_ == 0 ? 1 : -1) * PIECE_EVAL_VALUES[move.piece_id()];
+  if (covers_cache) {
+    value += tiles.influence(3);
+  } else {
+    // Only the mover's influence needs a flood fill.
+    value += tiles.influence(1u << player_) +
+             (player_ == 0 ? -cache.count : cache.count);
+  }
+  return player_ == 0 ? -value : value;
+}
+
+template <class Game>
+void BoardImpl<Game>::child_nega_evals(std::span<const Move> moves,
+                                       std::span<int> values) const {
+  size_t i = 0;
+  if constexpr (std::is_same_v<Game, BlokusDuoMini>) {
+    const auto mini_influence_x4 = kernels().mini_influence_x4;
+    for (; mini_influence_x4 && i + 4 <= moves.size(); i += 4) {
+      uint64_t packed[2][4];
+      int piece_evals[4];
+      for (int lane = 0; lane < 4; lane++) {
+        const Move move = moves[i + lane];
+        PackedTiles<Game> tiles(key_);
+        piece_evals[lane] = piece_eval_;
+        if (!move.is_pass()) {
+          tiles.place(player_, move);
+          piece_evals[lane] +=
+              (player_ == 0 ? 1 : -1) * PIECE_EVAL_VALUES[move.piece_id()];
+        }
+        packed[0][lane] = tiles.tiles[0];
+        packed[1][lane] = tiles.tiles[1];
+      }
+      int64_t influence[4];
+      mini_influence_x4(packed, influence);
+      for (int lane = 0; lane < 4; lane++) {
+        const int value = piece_evals[lane] + influence[lane];
+        values[i + lane] = player_ == 0 ? -value : value;
+      }
     }
+  }
+  for (; i < moves.size(); i++) values[i] = child_nega_eval(moves[i]);
+}
+
+template <class Game>
+void BoardImpl<Game>::open_rows(int player, bool seed_start,
+                                std::array<uint16_t, YSIZE>* anchors,
+                                std::array<uint16_t, YSIZE>* open,
+                                std::array<uint16_t, YSIZE>* blocked) const {
+  constexpr uint16_t ROW_MASK = (uint16_t{1} << XSIZE) - 1;
+  std::array<uint16_t, YSIZE> own;
+  bool has_tiles = false;
+  for (int y = 0; y < YSIZE; y++) {
+    own[y] = key_.a[player][y] & ROW_MASK;
+    has_tiles |= own[y] != 0;
+  }
+  for (int y = 0; y < YSIZE; y++) {
+    const uint16_t up_down = (y > 0 ? own[y - 1] : 0) |
+                             (y + 1 < YSIZE ? own[y + 1] : 0);
+    const uint16_t edge = ((own[y] << 1) | (own[y] >> 1) | up_down) & ROW_MASK;
+    uint16_t corner = ((up_down << 1) | (up_down >> 1)) & ROW_MASK;
+    const int start_x = player == 0 ? Game::START1X : Game::START2X;
+    const int start_y = player == 0 ? Game::START1Y : Game::START2Y;
+    if (seed_start && !has_tiles && y == start_y)
+      corner |= uint16_t{1} << start_x;
+    const uint16_t blocked_row =
+        own[y] | edge | (key_.a[1 - player][y] & ROW_MASK);
+    (*anchors)[y] = corner & ~blocked_row;
+    if (open) (*open)[y] = ~blocked_row & ROW_MASK;
+    if (blocked) (*blocked)[y] = blocked_row;
+  }
+}
 
-    for (int distance = 0; distance < 3; distance++) {
-      const Bits adjacent = orthogonal_neighbors(frontier);
-      for (int word = 0; word < 4; word++) {
-        frontier[word] = adjacent[word] & traversable[word] & ~reached[word];
-        reached[word] |= frontier[word];
+template <class Game>
+std::array<uint16_t, BoardImpl<Game>::YSIZE> BoardImpl<Game>::reachable_rows(
+    int player, int max_cells, const std::array<uint16_t, YSIZE>& stop) const {
+  constexpr uint16_t ROW_MASK = (uint16_t{1} << XSIZE) - 1;
+  std::array<uint16_t, YSIZE> reached, open;
+  open_rows(player, true, &reached, &open);
+  // Grow the region by king steps until it stops changing. Diagonal steps
+  // are needed because every placed piece creates anchors diagonally.
+  for (bool changed = true; changed;) {
+    changed = false;
+    int cells = 0;
+    uint16_t above = 0, stopped = 0;
+    for (int y = 0; y < YSIZE; y++) {
+      const uint16_t row = reached[y];
+      const uint16_t below = y + 1 < YSIZE ? reached[y + 1] : 0;
+      const uint16_t span = above | row | below;
+      const uint16_t grown =
+          (span | (span << 1) | (span >> 1)) & open[y] & ROW_MASK;
+      above = row;
+      cells += std::popcount(row);
+      stopped |= row & stop[y];
+      if (grown != row) {
+        reached[y] = grown;
+        changed = true;
       }
     }
-    for (uint64_t word : reached) influence[player] += std::popcount(word);
+    if (cells > max_cells || stopped) break;
   }
-  return influence[0] - influence[1];
-#endif
+  return reached;
 }
 
 // static
@@ -703,51 +820,89 @@ std::vector<Move> BoardImpl<Game>::all_possible_moves() {
 
 // static
 template <class Game>
-Move BoardImpl<Game>::rotate_move(Move m, int rotation) {
-  if (m.is_pass()) return m;
-  m = m.canonicalize();
-  int x, y;
+std::pair<int, int> BoardImpl<Game>::rotate_point(int x, int y,
+                                                  int rotation) {
   switch (rotation & 7) {
     case 0:
-      x = m.x();
-      y = m.y();
-      break;
+      return {x, y};
     case 1:
-      x = XSIZE - 1 - m.x();
-      y = m.y();
-      break;
+      return {XSIZE - 1 - x, y};
     case 2:
-      x = XSIZE - 1 - m.y();
-      y = m.x();
-      break;
+      return {XSIZE - 1 - y, x};
     case 3:
-      x = m.y();
-      y = m.x();
-      break;
+      return {y, x};
     case 4:
-      x = XSIZE - 1 - m.x();
-      y = YSIZE - 1 - m.y();
-      break;
+      return {XSIZE - 1 - x, YSIZE - 1 - y};
     case 5:
-      x = m.x();
-      y = YSIZE - 1 - m.y();
-      break;
+      return {x, YSIZE - 1 - y};
     case 6:
-      x = m.y();
-      y = YSIZE - 1 - m.x();
-      break;
-    case 7:
-      x = XSIZE - 1 - m.y();
-      y = YSIZE - 1 - m.x();
-      break;
+      return {y, YSIZE - 1 - x};
+    default:
+      return {XSIZE - 1 - y, YSIZE - 1 - x};
   }
+}
+
+template <class Game>
+typename BoardImpl<Game>::Key BoardImpl<Game>::transposed_key() const {
+  static_assert(XSIZE == YSIZE);
+  constexpr uint16_t ROW_MASK = (uint16_t{1} << XSIZE) - 1;
+  Key key = key_;
+  for (int player = 0; player < 2; player++) {
+    uint16_t columns[XSIZE] = {};
+    for (int y = 0; y < YSIZE; y++) {
+      for (uint16_t cells = key_.a[player][y] & ROW_MASK; cells != 0;
+           cells &= cells - 1) {
+        columns[std::countr_zero(cells)] |= uint16_t{1} << y;
+      }
+    }
+    // Keep the pass and turn bits above the row.
+    for (int y = 0; y < YSIZE; y++)
+      key.a[player][y] = (key_.a[player][y] & ~ROW_MASK) | columns[y];
+  }
+  return key;
+}
+
+// static
+template <class Game>
+Move BoardImpl<Game>::rotate_move(Move m, int rotation) {
+  if (m.is_pass()) return m;
+  m = m.canonicalize();
+  const auto [x, y] = rotate_point(m.x(), m.y(), rotation);
   int orientation =
       (m.orientation() + (m.orientation() & 1 ? 8 - rotation : rotation)) & 7;
   return Move(x, y, m.piece_id() << 3 | orientation).canonicalize();
 }
 
+// static
+template <class Game>
+int BoardImpl<Game>::action_id(Move move) {
+  if (move.is_pass()) return NUM_ACTIONS - 1;
+  move = move.canonicalize();
+  const Piece* p =
+      block_set[move.piece_id()].rotations[move.orientation()].piece;
+  const int width = XSIZE - (p->maxx - p->minx);
+  return Game::action_offsets[p->id] + (move.y() + p->miny) * width +
+         move.x() + p->minx;
+}
+
+// static
+template <class Game>
+Move BoardImpl<Game>::action_move(int id) {
+  if (id == NUM_ACTIONS - 1) return Move::pass();
+  // piece_set is sorted by action offset.
+  const auto next = std::upper_bound(
+      Game::piece_set.begin(), Game::piece_set.end(), id,
+      [](int id, const Piece* p) { return id < Game::action_offsets[p->id]; });
+  const Piece* p = *(next - 1);
+  const int width = XSIZE - (p->maxx - p->minx);
+  const int offset = id - Game::action_offsets[p->id];
+  return Move(offset % width - p->minx, offset / width - p->miny, p->id);
+}
+
 // explicit instantiation
 template class BoardImpl<BlokusDuoMini>;
 template class BoardImpl<BlokusDuoStandard>;
+template class MoveList<BlokusDuoMini>;
+template class MoveList<BlokusDuoStandard>;
 
 }  // namespace blokusduo
@@ -4,12 +4,17 @@
 #include <stdlib.h>
 #include <time.h>
 
+#include <algorithm>
+#include <bit>
 #include <iostream>
 #include <queue>
 #include <random>
 #include <unordered_set>
 
 #include "blokusduo.h"
+#include "kernels.h"
+#include "move_list.h"
+#include "move_visitors.h"
 #include "piece.h"
 
 namespace blokusduo {
@@ -20,19 +25,27 @@ std::ostream& operator<<(std::ostream& os, const Move& m) {
 
 namespace {
 
+// Collects the moves in the order they are visited, skipping the moves of
+// `skipped`.
 template <class Game>
-class MoveCollector : public BoardImpl<Game>::MoveVisitor {
+class MoveSequence : public BoardImpl<Game>::MoveVisitor {
  public:
-  virtual bool visit_move(Move m) {
-    valid_moves.insert(m);
+  explicit MoveSequence(char skipped = 0) : skipped(skipped) {}
+  bool filter(char piece, int, const BoardImpl<Game>&) noexcept override {
+    return piece != skipped;
+  }
+  bool visit_move(Move m) override {
+    moves.push_back(m);
     return true;
   }
-  std::unordered_set<Move, Move::Hash> valid_moves;
+  char skipped;
+  std::vector<Move> moves;
 };
 
-class InspectableInfluenceBoard : public standard::Board {
+template <class Game = BlokusDuoStandard>
+class InspectableInfluenceBoard : public BoardImpl<Game> {
  public:
-  int influence() const { return eval_influence(); }
+  int influence() const { return this->eval_influence(); }
 };
 
 int reference_standard_influence(const standard::Board& board) {
@@ -172,7 +185,7 @@ TEST(Board, AllPossibleMoves) {
 TEST(Board, OptimizedStandardEvaluationMatchesReference) {
   std::mt19937 random(20260726);
   for (int game = 0; game < 20; game++) {
-    InspectableInfluenceBoard board;
+    InspectableInfluenceBoard<> board;
     while (!board.is_game_over()) {
       EXPECT_EQ(reference_standard_influence(board), board.influence());
       const std::vector<Move> moves = board.valid_moves();
@@ -209,8 +222,8 @@ TYPED_TEST(BoardTest, RandomPlayout) {
   while (!b.is_game_over()) {
     MoveCollector<TypeParam> collector;
     b.visit_moves(&collector);
-    std::unordered_set<Move, Move::Hash> valid_moves =
-        std::move(collector.valid_moves);
+    const std::unordered_set<Move, Move::Hash> valid_moves(
+        collector.moves.begin(), collector.moves.end());
 
     ASSERT_FALSE(valid_moves.empty());
     if (valid_moves.contains(Move::pass())) {
@@ -237,5 +250,199 @@ TYPED_TEST(BoardTest, RandomPlayout) {
   }
 }
 
+TYPED_TEST(BoardTest, MoveListsMatchVisitMoves) {
+  using Board = BoardImpl<TypeParam>;
+  std::mt19937 random(20261021);
+  for (int game = 0; game < 10; game++) {
+    Board board;
+    // Each list is updated only for its own player's moves.
+    MoveList<TypeParam> lists[2] = {{board, 0}, {board, 1}};
+    while (!board.is_game_over()) {
+      const std::vector<Move> moves = board.valid_moves();
+      const Move move = moves[random() % moves.size()];
+      if (board.turn() >= 2) {
+        const auto& list = lists[board.player()];
+        for (char skipped : {'\0', move.piece()}) {
+          MoveSequence<TypeParam> expected(skipped), actual(skipped);
+          board.visit_moves(&expected);
+          list.visit_moves(board, &actual);
+          EXPECT_EQ(expected.moves, actual.moves) << board.to_string();
+        }
+      }
+      const int player = board.player();
+      board.play_move(move);
+      lists[player].play_move(board, move);
+    }
+  }
+}
+
+TYPED_TEST(BoardTest, ActionIdsIndexAllPossibleMoves) {
+  using Board = BoardImpl<TypeParam>;
+  const std::vector<Move> moves = Board::all_possible_moves();
+  ASSERT_EQ(Board::NUM_ACTIONS, moves.size());
+  for (int id = 0; id < Board::NUM_ACTIONS; id++) {
+    EXPECT_EQ(id, Board::action_id(moves[id])) << moves[id];
+    EXPECT_EQ(moves[id], Board::action_move(id));
+  }
+  EXPECT_EQ(Board::NUM_ACTIONS - 1, Board::action_id(Move::pass()));
+
+  // Non-canonical orientations share the ID of their canonical move.
+  EXPECT_EQ(Board::action_id(Move("43b2")), Board::action_id(Move("33b6")));
+}
+
+TYPED_TEST(BoardTest, InfluenceRowsMatchEvaluation) {
+  std::mt19937 random(20260726);
+  for (int game = 0; game < 20; game++) {
+    InspectableInfluenceBoard<TypeParam> board;
+    while (!board.is_game_over()) {
+      int influence = 0;
+      for (int player = 0; player < 2; player++) {
+        for (uint16_t row : board.influence_rows(player))
+          influence += (player == 0 ? 1 : -1) * std::popcount(row);
+      }
+      EXPECT_EQ(board.influence(), influence);
+      const std::vector<Move> moves = board.valid_moves();
+      board.play_move(moves[random() % moves.size()]);
+    }
+  }
+}
+
+TYPED_TEST(BoardTest, ReachableRowsCoverLaterTiles) {
+  std::mt19937 random(20261018);
+  for (int game = 0; game < 20; game++) {
+    std::vector<BoardImpl<TypeParam>> history;
+    BoardImpl<TypeParam> board;
+    while (!board.is_game_over()) {
+      history.push_back(board);
+      const std::vector<Move> moves = board.valid_moves();
+      board.play_move(moves[random() % moves.size()]);
+    }
+    for (const BoardImpl<TypeParam>& before : history) {
+      for (int player = 0; player < 2; player++) {
+        const auto reachable = before.reachable_rows(player);
+        for (int y = 0; y < BoardImpl<TypeParam>::YSIZE; y++) {
+          for (int x = 0; x < BoardImpl<TypeParam>::XSIZE; x++) {
+            if (board.has_tile(player, x, y) &&
+                !before.has_tile(player, x, y)) {
+              EXPECT_TRUE(reachable[y] >> x & 1) << before.to_string();
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TYPED_TEST(BoardTest, ChildNegaEvalMatchesChild) {
+  std::mt19937 random(20261019);
+  for (int game = 0; game < 5; game++) {
+    BoardImpl<TypeParam> board;
+    while (!board.is_game_over()) {
+      const auto cache = board.opponent_influence();
+      const std::vector<Move> moves = board.valid_moves();
+      std::vector<int> values(moves.size());
+      board.child_nega_evals(moves, values);
+      for (size_t i = 0; i < moves.size(); i++) {
+        const int expected = board.child(moves[i]).nega_eval();
+        EXPECT_EQ(expected, board.child_nega_eval(moves[i]))
+            << board.to_string() << moves[i].code();
+        EXPECT_EQ(expected, board.child_nega_eval(moves[i], cache))
+            << board.to_string() << moves[i].code();
+        EXPECT_EQ(expected, values[i]) << board.to_string() << moves[i].code();
+      }
+      board.play_move(moves[random() % moves.size()]);
+    }
+  }
+}
+
+TYPED_TEST(BoardTest, TransposedBoardIsEquivalent) {
+  using Board = BoardImpl<TypeParam>;
+  std::mt19937 random(20261101);
+  for (int game = 0; game < 5; game++) {
+    Board board, transposed;
+    while (!board.is_game_over()) {
+      EXPECT_TRUE(transposed.key() == board.transposed_key())
+          << board.to_string();
+      EXPECT_TRUE(board.key() == transposed.transposed_key())
+          << board.to_string();
+      EXPECT_EQ(board.nega_eval(), transposed.nega_eval()) << board.to_string();
+      std::vector<Move> moves = board.valid_moves();
+      std::vector<Move> transposed_moves;
+      for (Move move : moves)
+        transposed_moves.push_back(Board::rotate_move(move, Board::TRANSPOSE));
+      std::vector<Move> expected_moves = transposed.valid_moves();
+      std::sort(transposed_moves.begin(), transposed_moves.end());
+      std::sort(expected_moves.begin(), expected_moves.end());
+      EXPECT_EQ(expected_moves, transposed_moves) << board.to_string();
+
+      const Move move = moves[random() % moves.size()];
+      board.play_move(move);
+      transposed.play_move(Board::rotate_move(move, Board::TRANSPOSE));
+    }
+  }
+}
+
+TYPED_TEST(BoardTest, EvaluateBatchMatchesEvaluate) {
+  std::mt19937 random(20260726);
+  std::vector<BoardImpl<TypeParam>> boards;
+  for (int game = 0; game < 3; game++) {
+    BoardImpl<TypeParam> b;
+    while (!b.is_game_over()) {
+      boards.push_back(b);
+      const std::vector<Move> moves = b.valid_moves();
+      b.play_move(moves[random() % moves.size()]);
+    }
+    boards.push_back(b);
+  }
+  // Cover a partial batch at the end.
+  if (boards.size() % 4 == 0) boards.pop_back();
+
+  std::vector<int> values(boards.size());
+  BoardImpl<TypeParam>::evaluate_batch(boards, values);
+  for (size_t i = 0; i < boards.size(); i++)
+    EXPECT_EQ(boards[i].evaluate(), values[i]) << boards[i].to_string();
+}
+
+TYPED_TEST(BoardTest, AllKernelsAgree) {
+  std::mt19937 random(20261020);
+  std::vector<BoardImpl<TypeParam>> boards;
+  for (int game = 0; game < 3; game++) {
+    BoardImpl<TypeParam> b;
+    while (!b.is_game_over()) {
+      boards.push_back(b);
+      const std::vector<Move> moves = b.valid_moves();
+      b.play_move(moves[random() % moves.size()]);
+    }
+  }
+
+  // Everything each kernel set computes, for all the boards.
+  const auto outputs = [&boards] {
+    std::vector<int> values(boards.size());
+    BoardImpl<TypeParam>::evaluate_batch(boards, values);
+    std::vector<std::vector<Move>> moves;
+    for (const auto& board : boards) {
+      values.push_back(board.evaluate());
+      moves.push_back(board.valid_moves());
+      std::vector<int> children(moves.back().size());
+      board.child_nega_evals(moves.back(), children);
+      values.insert(values.end(), children.begin(), children.end());
+    }
+    return std::make_pair(values, moves);
+  };
+
+  const char* initial = kernels().name;
+  const std::vector<const Kernels*> supported = supported_kernels();
+  ASSERT_TRUE(use_kernels(supported.back()->name));
+  const auto expected = outputs();
+  for (const Kernels* set : supported) {
+    ASSERT_TRUE(use_kernels(set->name));
+    const auto actual = outputs();
+    EXPECT_TRUE(actual.first == expected.first) << set->name;
+    EXPECT_TRUE(actual.second == expected.second) << set->name;
+  }
+  EXPECT_FALSE(use_kernels("unknown"));
+  ASSERT_TRUE(use_kernels(initial));
+}
+
 }  // namespace
 }  // namespace blokusduo
@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "kernels.h"
+
+namespace blokusduo {
+
+// Defined by the builds of kernels.cpp.
+#if defined(BLOKUSDUO_ENABLE_DISPATCH)
+extern const Kernels kernels_scalar;
+extern const Kernels kernels_avx2;
+extern const Kernels kernels_avx512;
+#else
+extern const Kernels kernels_native;
+#endif
+
+namespace {
+
+#if defined(BLOKUSDUO_ENABLE_DISPATCH)
+// The features each build is compiled for; see CMakeLists.txt.
+bool supports_avx2() {
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi") &&
+         __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("fma") &&
+         __builtin_cpu_supports("popcnt");
+}
+
+bool supports_avx512() {
+  return supports_avx2() && __builtin_cpu_supports("avx512f") &&
+         __builtin_cpu_supports("avx512bw") &&
+         __builtin_cpu_supports("avx512vl") &&
+         __builtin_cpu_supports("avx512vpopcntdq");
+}
+#endif
+
+}  // namespace
+
+// Until the initializer below runs, use the set every CPU can run.
+#if defined(BLOKUSDUO_ENABLE_DISPATCH)
+const Kernels* active_kernels = &kernels_scalar;
+#else
+const Kernels* active_kernels = &kernels_native;
+#endif
+
+std::vector<const Kernels*> supported_kernels() {
+  std::vector<const Kernels*> kernels;
+#if defined(BLOKUSDUO_ENABLE_DISPATCH)
+  __builtin_cpu_init();
+  if (supports_avx512()) kernels.push_back(&kernels_avx512);
+  if (supports_avx2()) kernels.push_back(&kernels_avx2);
+  kernels.push_back(&kernels_scalar);
+#else
+  kernels.push_back(&kernels_native);
+#endif
+  return kernels;
+}
+
+bool use_kernels(std::string_view name) {
+  for (const Kernels* kernels : supported_kernels()) {
+    if (name == kernels->name) {
+      active_kernels = kernels;
+      return true;
+    }
+  }
+  return false;
+}
+
+namespace {
+
+[[maybe_unused]] const bool kernels_selected = [] {
+  active_kernels = supported_kernels().front();
+  const char* name = getenv("BLOKUSDUO_KERNELS");
+  if (name != nullptr && *name != '\0' && !use_kernels(name)) {
+    fprintf(stderr,
+            "BLOKUSDUO_KERNELS=%s is not supported on this CPU; using %s\n",
+            name, active_kernels->name);
+  }
+  return true;
+}();
+
+}  // namespace
+
+}  // namespace blokusduo
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "blokusduo.h"
+#include "search_move.h"
+
+namespace blokusduo::search {
+namespace {
+
+struct Options {
+  bool mini = false;
+  int games = 8;
+  int wld_turn = -1;      // Defaults to MoveSchedule<Game>::WLD_TURN.
+  int perfect_turn = -1;  // Defaults to MoveSchedule<Game>::PERFECT_TURN.
+};
+
+// The endgame prunings to compare, each measured on the same positions.
+struct Variant {
+  const char* name;
+  EndgameOptions options;
+};
+const Variant VARIANTS[] = {
+    {"alpha-beta",
+     {.capacity_bounds = false, .split_regions = false, .single_player = false}},
+    {"capacity bounds",
+     {.capacity_bounds = true, .split_regions = false, .single_player = false}},
+    {"single player",
+     {.capacity_bounds = true, .split_regions = false, .single_player = true}},
+    {"region split",
+     {.capacity_bounds = true, .split_regions = true, .single_player = true}},
+};
+constexpr int NUM_VARIANTS = sizeof(VARIANTS) / sizeof(VARIANTS[0]);
+
+double elapsed_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// Plays a shallow, randomized game up to `turn`. Returns false if the game
+// ended before.
+template <class Game>
+bool late_position(int game, int turn, BoardImpl<Game>* board) {
+  *board = BoardImpl<Game>();
+  while (board->turn() < turn) {
+    if (board->is_game_over()) return false;
+    board->play_move(negascout_gumbel(*board, 2, 4, game * 100 + board->turn(),
+                                      [](int, SearchResult) { return true; })
+                         .first);
+  }
+  return !board->is_game_over();
+}
+
+// Solves the position of every game at `turn` with each variant, and prints
+// the total nodes and time relative to the first variant.
+template <class Game>
+void measure(const char* solver, int turn, int games,
+             SearchResult (*solve)(const BoardImpl<Game>&,
+                                   const EndgameOptions&)) {
+  long nodes[NUM_VARIANTS] = {};
+  double seconds[NUM_VARIANTS] = {};
+  int positions = 0;
+  for (int game = 0; game < games; game++) {
+    BoardImpl<Game> board;
+    if (!late_position(game, turn, &board)) continue;
+    positions++;
+    int expected = 0;
+    for (int v = 0; v < NUM_VARIANTS; v++) {
+      const auto start = std::chrono::steady_clock::now();
+      visited_nodes = 0;
+      const int value = solve(board, VARIANTS[v].options).second;
+      seconds[v] += elapsed_since(start);
+      nodes[v] += visited_nodes;
+      // wld() values are only exact in sign.
+      const int outcome = strcmp(solver, "wld") == 0
+                              ? (value > 0) - (value < 0)
+                              : value;
+      if (v == 0)
+        expected = outcome;
+      else if (outcome != expected)
+        printf("game %d: %s disagrees (%d, expected %d)\n", game,
+               VARIANTS[v].name, outcome, expected);
+    }
+  }
+  printf("%s at turn %d, %d positions:\n", solver, turn, positions);
+  for (int v = 0; v < NUM_VARIANTS; v++) {
+    printf("  %-16s %10ld nodes (%5.1f%%) %8.3f sec\n", VARIANTS[v].name,
+           nodes[v], 100.0 * nodes[v] / std::max(nodes[0], 1L), seconds[v]);
+  }
+  fflush(stdout);
+}
+
+template <class Game>
+void run(const Options& options) {
+  using Schedule = MoveSchedule<Game>;
+  measure<Game>("wld",
+                options.wld_turn >= 0 ? options.wld_turn : Schedule::WLD_TURN,
+                options.games, &wld<Game>);
+  measure<Game>("perfect",
+                options.perfect_turn >= 0 ? options.perfect_turn
+                                          : Schedule::PERFECT_TURN,
+                options.games, &perfect<Game>);
+}
+
+void usage(const char* program) {
+  fprintf(stderr,
+          "Usage: %s [--mini] [--games N] [--wld-turn T] [--perfect-turn T]\n",
+          program);
+  exit(2);
+}
+
+Options parse_options(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (strcmp(arg, "--mini") == 0) {
+      options.mini = true;
+      continue;
+    }
+    if (i + 1 >= argc) usage(argv[0]);
+    const char* value = argv[++i];
+    if (strcmp(arg, "--games") == 0) {
+      options.games = atoi(value);
+    } else if (strcmp(arg, "--wld-turn") == 0) {
+      options.wld_turn = atoi(value);
+    } else if (strcmp(arg, "--perfect-turn") == 0) {
+      options.perfect_turn = atoi(value);
+    } else {
+      usage(argv[0]);
+    }
+  }
+  return options;
+}
+
+}  // namespace
+}  // namespace blokusduo::search
+
+int main(int argc, char** argv) {
+  using namespace blokusduo;
+  const search::Options options = search::parse_options(argc, argv);
+  if (options.mini)
+    search::run<BlokusDuoMini>(options);
+  else
+    search::run<BlokusDuoStandard>(options);
+  return 0;
+}
@@ -0,0 +1,92 @@
+#include <stdio.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "blokusduo.h"
+
+namespace blokusduo {
+namespace {
+
+// Collects every position of random playouts until `count` boards are
+// gathered.
+template <class Game>
+std::vector<BoardImpl<Game>> random_positions(size_t count) {
+  std::mt19937 random(20260726);
+  std::vector<BoardImpl<Game>> boards;
+  boards.reserve(count);
+  while (boards.size() < count) {
+    BoardImpl<Game> board;
+    while (!board.is_game_over() && boards.size() < count) {
+      boards.push_back(board);
+      const std::vector<Move> moves = board.valid_moves();
+      board.play_move(moves[random() % moves.size()]);
+    }
+  }
+  return boards;
+}
+
+// Runs `body` repeatedly for about half a second and returns the number of
+// evaluations per second, given that each run evaluates `count` boards.
+template <class F>
+double evals_per_second(size_t count, F body) {
+  using clock = std::chrono::steady_clock;
+  const auto start = clock::now();
+  size_t evaluations = 0;
+  std::chrono::duration<double> elapsed;
+  do {
+    body();
+    evaluations += count;
+    elapsed = clock::now() - start;
+  } while (elapsed.count() < 0.5);
+  return evaluations / elapsed.count();
+}
+
+// Counts the moves visited, so that move generation can be timed without
+// storing them.
+template <class Game>
+class MoveCounter : public BoardImpl<Game>::MoveVisitor {
+ public:
+  bool visit_move(Move) override {
+    moves++;
+    return true;
+  }
+  long moves = 0;
+};
+
+template <class Game>
+void benchmark(const char* name) {
+  const std::vector<BoardImpl<Game>> boards = random_positions<Game>(4096);
+  std::vector<int> values(boards.size());
+  long checksum = 0;
+
+  const double scalar = evals_per_second(boards.size(), [&] {
+    for (size_t i = 0; i < boards.size(); i++) values[i] = boards[i].evaluate();
+    checksum += values[0];
+  });
+  const double batch = evals_per_second(boards.size(), [&] {
+    BoardImpl<Game>::evaluate_batch(boards, values);
+    checksum += values[0];
+  });
+  MoveCounter<Game> counter;
+  const double generation = evals_per_second(boards.size(), [&] {
+    for (const BoardImpl<Game>& board : boards) board.visit_moves(&counter);
+  });
+  printf("%-8s %-17s %12.0f evals/sec\n", name, "evaluate():", scalar);
+  printf("%-8s %-17s %12.0f evals/sec (%.2fx)\n", name, "evaluate_batch():",
+         batch, batch / scalar);
+  printf("%-8s %-17s %12.0f boards/sec\n", name, "visit_moves():",
+         generation);
+  // Keep the loops observable.
+  if (checksum == 1 || counter.moves == 1) printf("\n");
+}
+
+}  // namespace
+}  // namespace blokusduo
+
+int main() {
+  blokusduo::benchmark<blokusduo::BlokusDuoMini>("mini");
+  blokusduo::benchmark<blokusduo::BlokusDuoStandard>("standard");
+  return 0;
+}
@@ -0,0 +1,152 @@
+#include <assert.h>
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include "blokusduo_evaluator.h"
+
+namespace blokusduo::search {
+
+template <class Game>
+void BuiltinEvaluator<Game>::evaluate(std::span<const BoardImpl<Game>> boards,
+                                      std::span<int> values) {
+  BoardImpl<Game>::evaluate_batch(boards, values);
+  for (size_t i = 0; i < boards.size(); i++) {
+    if (!boards[i].is_violet_turn()) values[i] = -values[i];
+  }
+}
+
+template <class Game>
+BatchingEvaluator<Game>::BatchingEvaluator(
+    LeafEvaluator<Game>* backend, int batch_size,
+    std::chrono::microseconds max_latency)
+    : backend_(backend), batch_size_(batch_size), max_latency_(max_latency) {
+  assert(batch_size > 0);
+}
+
+template <class Game>
+void BatchingEvaluator<Game>::evaluate(std::span<const BoardImpl<Game>> boards,
+                                       std::span<int> values) {
+  if (boards.empty()) return;
+  Request request{boards, values, boards.size(), boards.size()};
+  const auto deadline = std::chrono::steady_clock::now() + max_latency_;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  queue_.push_back(&request);
+  queued_positions_ += boards.size();
+  // Whoever finds a full batch, or a late one, evaluates it.
+  while (request.pending > 0) {
+    const bool late = std::chrono::steady_clock::now() >= deadline;
+    if (queued_positions_ >= batch_size_ || (late && queued_positions_ > 0))
+      run_batch(lock);
+    else if (late)
+      done_.wait(lock);
+    else
+      done_.wait_until(lock, deadline);
+  }
+}
+
+template <class Game>
+void BatchingEvaluator<Game>::run_batch(std::unique_lock<std::mutex>& lock) {
+  // Take whole or partial requests from the front of the queue.
+  std::vector<std::tuple<Request*, size_t, size_t>> parts;
+  std::vector<BoardImpl<Game>> batch;
+  batch.reserve(std::min(batch_size_, queued_positions_));
+  while (!queue_.empty() && batch.size() < batch_size_) {
+    Request* request = queue_.front();
+    const size_t begin = request->boards.size() - request->queued;
+    const size_t count =
+        std::min(request->queued, batch_size_ - batch.size());
+    parts.emplace_back(request, begin, count);
+    batch.insert(batch.end(), request->boards.begin() + begin,
+                 request->boards.begin() + begin + count);
+    request->queued -= count;
+    if (request->queued == 0) queue_.pop_front();
+  }
+  queued_positions_ -= batch.size();
+
+  lock.unlock();
+  std::vector<int> values(batch.size());
+  backend_->evaluate(batch, values);
+  lock.lock();
+
+  size_t offset = 0;
+  for (auto [request, begin, count] : parts) {
+    std::copy_n(values.begin() + offset, count,
+                request->values.begin() + begin);
+    request->pending -= count;
+    offset += count;
+  }
+  batches_++;
+  positions_ += batch.size();
+  done_.notify_all();
+}
+
+template <class Game>
+long BatchingEvaluator<Game>::batches() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return batches_;
+}
+
+template <class Game>
+long BatchingEvaluator<Game>::positions() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return positions_;
+}
+
+template <class Game>
+CachingEvaluator<Game>::CachingEvaluator(LeafEvaluator<Game>* backend,
+                                         int bits)
+    : backend_(backend),
+      mask_((uint64_t{1} << bits) - 1),
+      entries_(size_t{1} << bits) {
+  assert(bits > 0 && bits <= 32);
+}
+
+template <class Game>
+void CachingEvaluator<Game>::evaluate(std::span<const BoardImpl<Game>> boards,
+                                      std::span<int> values) {
+  std::vector<BoardImpl<Game>> misses;
+  std::vector<size_t> miss_indices;
+  for (size_t i = 0; i < boards.size(); i++) {
+    const uint64_t h = hash(boards[i]);
+    const uint64_t entry =
+        entries_[h & mask_].load(std::memory_order_relaxed);
+    if (entry >> 32 == check(h)) {
+      values[i] = static_cast<int32_t>(entry);
+    } else {
+      misses.push_back(boards[i]);
+      miss_indices.push_back(i);
+    }
+  }
+  lookups_.fetch_add(boards.size(), std::memory_order_relaxed);
+  hits_.fetch_add(boards.size() - misses.size(), std::memory_order_relaxed);
+  if (misses.empty()) return;
+
+  std::vector<int> miss_values(misses.size());
+  backend_->evaluate(misses, miss_values);
+  for (size_t j = 0; j < misses.size(); j++) {
+    const uint64_t h = hash(misses[j]);
+    entries_[h & mask_].store(
+        check(h) << 32 | static_cast<uint32_t>(miss_values[j]),
+        std::memory_order_relaxed);
+    values[miss_indices[j]] = miss_values[j];
+  }
+}
+
+template <class Game>
+void CachingEvaluator<Game>::clear() {
+  for (auto& entry : entries_) entry.store(0, std::memory_order_relaxed);
+  lookups_ = 0;
+  hits_ = 0;
+}
+
+template class BuiltinEvaluator<BlokusDuoMini>;
+template class BuiltinEvaluator<BlokusDuoStandard>;
+template class BatchingEvaluator<BlokusDuoMini>;
+template class BatchingEvaluator<BlokusDuoStandard>;
+template class CachingEvaluator<BlokusDuoMini>;
+template class CachingEvaluator<BlokusDuoStandard>;
+
+}  // namespace blokusduo::search
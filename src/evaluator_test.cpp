@@ -0,0 +1,129 @@
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "blokusduo_evaluator.h"
+
+namespace blokusduo::search {
+namespace {
+
+template <class Game>
+std::vector<BoardImpl<Game>> random_positions(size_t count, uint64_t seed) {
+  std::mt19937 random(seed);
+  std::vector<BoardImpl<Game>> boards;
+  BoardImpl<Game> board;
+  while (boards.size() < count) {
+    if (board.is_game_over()) board = BoardImpl<Game>();
+    boards.push_back(board);
+    const std::vector<Move> moves = board.valid_moves();
+    board.play_move(moves[random() % moves.size()]);
+  }
+  return boards;
+}
+
+// Wraps BuiltinEvaluator and records the largest batch it was given, and the
+// positions it was given in all.
+template <class Game>
+class RecordingEvaluator : public LeafEvaluator<Game> {
+ public:
+  void evaluate(std::span<const BoardImpl<Game>> boards,
+                std::span<int> values) override {
+    size_t max = max_batch;
+    while (boards.size() > max &&
+           !max_batch.compare_exchange_weak(max, boards.size())) {
+    }
+    positions += boards.size();
+    builtin.evaluate(boards, values);
+  }
+  BuiltinEvaluator<Game> builtin;
+  std::atomic<size_t> max_batch = 0;
+  std::atomic<size_t> positions = 0;
+};
+
+template <typename T>
+class EvaluatorTest : public testing::Test {};
+
+using Games = ::testing::Types<BlokusDuoMini, BlokusDuoStandard>;
+TYPED_TEST_SUITE(EvaluatorTest, Games);
+
+TYPED_TEST(EvaluatorTest, BuiltinMatchesNegaEval) {
+  const auto boards = random_positions<TypeParam>(100, 1);
+  std::vector<int> values(boards.size());
+  BuiltinEvaluator<TypeParam>().evaluate(boards, values);
+  for (size_t i = 0; i < boards.size(); i++)
+    EXPECT_EQ(boards[i].nega_eval(), values[i]);
+}
+
+TYPED_TEST(EvaluatorTest, BatchesConcurrentRequests) {
+  constexpr int THREADS = 8, BATCH_SIZE = 16;
+  RecordingEvaluator<TypeParam> backend;
+  BatchingEvaluator<TypeParam> batching(&backend, BATCH_SIZE,
+                                        std::chrono::milliseconds(10));
+  std::atomic<int> mismatches = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; t++) {
+    threads.emplace_back([&, t] {
+      const auto boards = random_positions<TypeParam>(200, t);
+      // Requests of 1 to 20 positions, some larger than a batch.
+      for (size_t i = 0, size = 1; i < boards.size();
+           i += size, size = size % 20 + 1) {
+        const auto request = std::span(boards).subspan(
+            i, std::min(size, boards.size() - i));
+        std::vector<int> values(request.size());
+        batching.evaluate(request, values);
+        for (size_t j = 0; j < request.size(); j++)
+          mismatches += values[j] != request[j].nega_eval();
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  EXPECT_EQ(0, mismatches);
+  EXPECT_EQ(THREADS * 200, batching.positions());
+  EXPECT_LE(backend.max_batch, BATCH_SIZE);
+  EXPECT_LT(batching.batches(), batching.positions());
+}
+
+TYPED_TEST(EvaluatorTest, FlushesPartialBatchAfterLatency) {
+  RecordingEvaluator<TypeParam> backend;
+  BatchingEvaluator<TypeParam> batching(&backend, 1024,
+                                        std::chrono::microseconds(100));
+  const auto boards = random_positions<TypeParam>(3, 2);
+  std::vector<int> values(boards.size());
+  batching.evaluate(boards, values);
+  for (size_t i = 0; i < boards.size(); i++)
+    EXPECT_EQ(boards[i].nega_eval(), values[i]);
+  EXPECT_EQ(1, batching.batches());
+  EXPECT_EQ(3, backend.max_batch);
+}
+
+TYPED_TEST(EvaluatorTest, CachesValues) {
+  RecordingEvaluator<TypeParam> backend;
+  CachingEvaluator<TypeParam> caching(&backend, 10);
+  const auto boards = random_positions<TypeParam>(100, 3);
+  std::vector<int> values(boards.size());
+  caching.evaluate(boards, values);
+  for (size_t i = 0; i < boards.size(); i++)
+    EXPECT_EQ(boards[i].nega_eval(), values[i]);
+  EXPECT_EQ(100, caching.lookups());
+
+  // The second pass finds every position that kept its entry.
+  std::fill(values.begin(), values.end(), 0);
+  caching.evaluate(boards, values);
+  for (size_t i = 0; i < boards.size(); i++)
+    EXPECT_EQ(boards[i].nega_eval(), values[i]);
+  EXPECT_EQ(200, caching.lookups());
+  EXPECT_EQ(200 - caching.hits(), backend.positions);
+  EXPECT_GE(caching.hits(), 90);
+
+  caching.clear();
+  EXPECT_EQ(0, caching.lookups());
+  caching.evaluate(std::span(boards).first(1), values);
+  EXPECT_EQ(0, caching.hits());
+}
+
+}  // namespace
+}  // namespace blokusduo::search
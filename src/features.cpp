@@ -0,0 +1,108 @@
+#include <assert.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <vector>
+
+#include "blokusduo.h"
+
+namespace blokusduo::features {
+namespace {
+
+template <class Game>
+using Rows = std::array<uint16_t, Game::YSIZE>;
+
+// For each symmetry, the action ID of every transformed action.
+template <class Game>
+const std::array<std::vector<uint16_t>, 8>& action_permutations() {
+  static const auto permutations = [] {
+    using Board = BoardImpl<Game>;
+    std::array<std::vector<uint16_t>, 8> result;
+    for (int symmetry = 0; symmetry < 8; symmetry++) {
+      result[symmetry].resize(Board::NUM_ACTIONS);
+      for (int id = 0; id < Board::NUM_ACTIONS; id++) {
+        result[symmetry][id] = Board::action_id(
+            Board::rotate_move(Board::action_move(id), symmetry));
+      }
+    }
+    return result;
+  }();
+  return permutations;
+}
+
+}  // namespace
+
+template <class Game>
+void encode(std::span<const BoardImpl<Game>> boards, int symmetry,
+            std::span<float> out) {
+  using Board = BoardImpl<Game>;
+  constexpr int AREA = Board::XSIZE * Board::YSIZE;
+  constexpr int PLANES = NUM_PLANES<Game>;
+  constexpr uint16_t ROW_MASK = (uint16_t{1} << Board::XSIZE) - 1;
+  assert(out.size() >= boards.size() * PLANES * AREA);
+
+  std::array<int, AREA> destination;
+  for (int y = 0; y < Board::YSIZE; y++) {
+    for (int x = 0; x < Board::XSIZE; x++) {
+      const auto [rx, ry] = Board::rotate_point(x, y, symmetry);
+      destination[y * Board::XSIZE + x] = ry * Board::XSIZE + rx;
+    }
+  }
+
+  std::fill_n(out.begin(), boards.size() * PLANES * AREA, 0.0f);
+  for (size_t i = 0; i < boards.size(); i++) {
+    const Board& board = boards[i];
+    float* planes = out.data() + i * PLANES * AREA;
+
+    std::array<Rows<Game>, REMAINING_PIECES> rows;
+    const int players[2] = {board.player(), board.opponent()};
+    for (int side = 0; side < 2; side++) {
+      for (int y = 0; y < Board::YSIZE; y++)
+        rows[OWN_TILES + side][y] = board.key().a[players[side]][y] & ROW_MASK;
+      board.open_rows(players[side], true, &rows[OWN_ANCHORS + side], nullptr,
+                      &rows[OWN_BLOCKED + side]);
+      rows[OWN_INFLUENCE + side] = board.influence_rows(players[side]);
+    }
+    for (int plane = 0; plane < REMAINING_PIECES; plane++) {
+      for (int y = 0; y < Board::YSIZE; y++) {
+        for (uint16_t bits = rows[plane][y]; bits != 0; bits &= bits - 1) {
+          const int x = std::countr_zero(bits);
+          planes[plane * AREA + destination[y * Board::XSIZE + x]] = 1;
+        }
+      }
+    }
+
+    for (int side = 0; side < 2; side++) {
+      for (int piece = 0; piece < Game::NUM_PIECES; piece++) {
+        if (!board.is_piece_available(players[side], piece)) continue;
+        const int plane = REMAINING_PIECES + side * Game::NUM_PIECES + piece;
+        std::fill_n(planes + plane * AREA, AREA, 1.0f);
+      }
+    }
+  }
+}
+template void encode<BlokusDuoMini>(
+    std::span<const BoardImpl<BlokusDuoMini>> boards, int symmetry,
+    std::span<float> out);
+template void encode<BlokusDuoStandard>(
+    std::span<const BoardImpl<BlokusDuoStandard>> boards, int symmetry,
+    std::span<float> out);
+
+template <class Game>
+void transform_policy(std::span<const float> policy, int symmetry,
+                      std::span<float> out) {
+  assert(policy.size() >= Game::NUM_ACTIONS);
+  assert(out.size() >= Game::NUM_ACTIONS);
+  const std::vector<uint16_t>& permutation =
+      action_permutations<Game>()[symmetry & 7];
+  for (int id = 0; id < Game::NUM_ACTIONS; id++)
+    out[permutation[id]] = policy[id];
+}
+template void transform_policy<BlokusDuoMini>(std::span<const float> policy,
+                                              int symmetry,
+                                              std::span<float> out);
+template void transform_policy<BlokusDuoStandard>(
+    std::span<const float> policy, int symmetry, std::span<float> out);
+
+}  // namespace blokusduo::features
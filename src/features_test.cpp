@@ -0,0 +1,111 @@
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "blokusduo.h"
+
+namespace blokusduo::features {
+namespace {
+
+template <class Game>
+std::vector<float> encode_one(const BoardImpl<Game>& board, int symmetry) {
+  std::vector<float> planes(NUM_PLANES<Game> * Game::YSIZE * Game::XSIZE);
+  encode<Game>(std::span(&board, 1), symmetry, planes);
+  return planes;
+}
+
+template <typename T>
+class FeaturesTest : public testing::Test {};
+
+using Games = ::testing::Types<BlokusDuoMini, BlokusDuoStandard>;
+TYPED_TEST_SUITE(FeaturesTest, Games);
+
+TYPED_TEST(FeaturesTest, PlanesDescribeTheBoard) {
+  using Board = BoardImpl<TypeParam>;
+  constexpr int AREA = Board::XSIZE * Board::YSIZE;
+  std::mt19937 random(20260726);
+  std::vector<Board> boards;
+  Board b;
+  while (!b.is_game_over()) {
+    boards.push_back(b);
+    const std::vector<Move> moves = b.valid_moves();
+    b.play_move(moves[random() % moves.size()]);
+  }
+
+  std::vector<float> planes(boards.size() * NUM_PLANES<TypeParam> * AREA);
+  encode<TypeParam>(boards, 0, planes);
+  for (size_t i = 0; i < boards.size(); i++) {
+    const Board& board = boards[i];
+    const float* p = planes.data() + i * NUM_PLANES<TypeParam> * AREA;
+    const auto own_influence = board.influence_rows(board.player());
+    const auto opponent_influence = board.influence_rows(board.opponent());
+    for (int y = 0; y < Board::YSIZE; y++) {
+      for (int x = 0; x < Board::XSIZE; x++) {
+        const int cell = y * Board::XSIZE + x;
+        EXPECT_EQ(board.has_tile(board.player(), x, y),
+                  p[OWN_TILES * AREA + cell]);
+        EXPECT_EQ(board.has_tile(board.opponent(), x, y),
+                  p[OPPONENT_TILES * AREA + cell]);
+        EXPECT_EQ((own_influence[y] >> x) & 1,
+                  p[OWN_INFLUENCE * AREA + cell]);
+        EXPECT_EQ((opponent_influence[y] >> x) & 1,
+                  p[OPPONENT_INFLUENCE * AREA + cell]);
+        // Anchors are never blocked, and occupied cells always are.
+        if (p[OWN_ANCHORS * AREA + cell]) {
+          EXPECT_FALSE(p[OWN_BLOCKED * AREA + cell]);
+        }
+        if (p[OWN_TILES * AREA + cell] || p[OPPONENT_TILES * AREA + cell]) {
+          EXPECT_TRUE(p[OWN_BLOCKED * AREA + cell]);
+          EXPECT_TRUE(p[OPPONENT_BLOCKED * AREA + cell]);
+        }
+      }
+    }
+    for (int piece = 0; piece < TypeParam::NUM_PIECES; piece++) {
+      EXPECT_EQ(board.is_piece_available(board.player(), piece),
+                p[(REMAINING_PIECES + piece) * AREA]);
+      EXPECT_EQ(board.is_piece_available(board.opponent(), piece),
+                p[(REMAINING_PIECES + TypeParam::NUM_PIECES + piece) * AREA +
+                  AREA - 1]);
+    }
+  }
+}
+
+TYPED_TEST(FeaturesTest, SymmetryMatchesRotatedGame) {
+  using Board = BoardImpl<TypeParam>;
+  std::mt19937 random(20260726);
+  std::vector<Move> history;
+  Board board;
+  while (!board.is_game_over()) {
+    const std::vector<Move> moves = board.valid_moves();
+    history.push_back(moves[random() % moves.size()]);
+    board.play_move(history.back());
+    if (board.turn() < 4) continue;
+
+    for (int symmetry = 0; symmetry < 8; symmetry++) {
+      SCOPED_TRACE(testing::Message() << "turn=" << board.turn()
+                                      << ", symmetry=" << symmetry);
+      Board rotated;
+      for (Move m : history)
+        rotated.play_move(Board::rotate_move(m, symmetry));
+      EXPECT_EQ(encode_one(rotated, 0), encode_one(board, symmetry));
+    }
+  }
+}
+
+TYPED_TEST(FeaturesTest, TransformPolicyFollowsRotateMove) {
+  using Board = BoardImpl<TypeParam>;
+  std::vector<float> policy(Board::NUM_ACTIONS), transformed(policy.size());
+  for (int id = 0; id < Board::NUM_ACTIONS; id++) policy[id] = id;
+  for (int symmetry = 0; symmetry < 8; symmetry++) {
+    transform_policy<TypeParam>(policy, symmetry, transformed);
+    for (int id = 0; id < Board::NUM_ACTIONS; id++) {
+      const Move rotated =
+          Board::rotate_move(Board::action_move(id), symmetry);
+      EXPECT_EQ(id, transformed[Board::action_id(rotated)]);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace blokusduo::features
@@ -0,0 +1,640 @@
+#include <array>
+#include <bit>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__wasm_simd128__)
+#include <arm_neon.h>
+#endif
+
+#include "kernels.h"
+
+// The name of the kernel set this build defines, which also names its
+// namespace and variable.
+#ifndef BLOKUSDUO_KERNELS
+#define BLOKUSDUO_KERNELS native
+#endif
+
+#define BLOKUSDUO_CONCAT_(a, b) a##b
+#define BLOKUSDUO_CONCAT(a, b) BLOKUSDUO_CONCAT_(a, b)
+#define BLOKUSDUO_STRING_(a) #a
+#define BLOKUSDUO_STRING(a) BLOKUSDUO_STRING_(a)
+
+namespace blokusduo {
+namespace BLOKUSDUO_KERNELS {
+namespace {
+
+// Each kernel set is built with its own instruction set flags, so it must not
+// share inline functions with external linkage, such as std::popcount(), with
+// the others: the linker would keep one set's copy for all of them.
+#if defined(_MSC_VER) && !defined(__clang__)
+inline int popcount64(uint64_t x) { return std::popcount(x); }
+inline int countr_zero32(uint32_t x) { return std::countr_zero(x); }
+#else
+inline int popcount64(uint64_t x) { return __builtin_popcountll(x); }
+// `x` must not be 0.
+inline int countr_zero32(uint32_t x) { return __builtin_ctz(x); }
+#endif
+
+constexpr uint64_t shu8x8(uint64_t bits) { return bits << 8; }
+constexpr uint64_t shd8x8(uint64_t bits) { return bits >> 8; }
+
+constexpr uint64_t shl8x8(uint64_t bits) {
+  constexpr uint64_t mask =
+      0b01111111'01111111'01111111'01111111'01111111'01111111'01111111'01111111;
+  return (bits & mask) << 1;
+}
+
+constexpr uint64_t shr8x8(uint64_t bits) {
+  constexpr uint64_t mask =
+      0b01111111'01111111'01111111'01111111'01111111'01111111'01111111'01111111;
+  return (bits >> 1) & mask;
+}
+
+constexpr uint64_t inflate8x8(uint64_t bits) {
+  return bits | shu8x8(bits) | shd8x8(bits) | shl8x8(bits) | shr8x8(bits);
+}
+
+// The Mini influence term for a board whose rows are packed into one 64-bit
+// word per player, row y in byte y.
+int mini_influence(const uint64_t (&tiles)[2], unsigned players) {
+  int influence[2] = {};
+  for (int player = 0; player < 2; player++) {
+    if (!(players >> player & 1)) continue;
+    const uint64_t own = tiles[player];
+    const uint64_t mask = ~(inflate8x8(own) | tiles[1 - player]);
+    uint64_t infl = (shu8x8(shl8x8(own)) | shd8x8(shl8x8(own)) |
+                     shu8x8(shr8x8(own)) | shd8x8(shr8x8(own))) &
+                    mask;
+    infl = inflate8x8(infl) & mask;
+    infl = inflate8x8(infl) & mask;
+    influence[player] = popcount64(infl);
+  }
+  return influence[0] - influence[1];
+}
+
+#if defined(__AVX2__)
+// Each 64-bit lane of a 256-bit register holds a whole 8x8 board, so four
+// boards are evaluated per call, and their violet and orange flood fills run
+// side by side in separate registers. The shifts mirror the *8x8 helpers
+// above lane by lane. Stores violet's minus orange's influence of lane i in
+// influence[i].
+void mini_influence_x4(const uint64_t (&tiles)[2][4],
+                       int64_t (&influence)[4]) {
+  const __m256i column_mask = _mm256_set1_epi64x(0x7f7f7f7f7f7f7f7f);
+  const auto shl = [&column_mask](__m256i bits) {
+    return _mm256_slli_epi64(_mm256_and_si256(bits, column_mask), 1);
+  };
+  const auto shr = [&column_mask](__m256i bits) {
+    return _mm256_and_si256(_mm256_srli_epi64(bits, 1), column_mask);
+  };
+  const auto inflate = [&shl, &shr](__m256i bits) {
+    return _mm256_or_si256(
+        _mm256_or_si256(bits, _mm256_or_si256(_mm256_slli_epi64(bits, 8),
+                                              _mm256_srli_epi64(bits, 8))),
+        _mm256_or_si256(shl(bits), shr(bits)));
+  };
+  const auto diagonal = [&shl, &shr](__m256i bits) {
+    const __m256i horizontal = _mm256_or_si256(shl(bits), shr(bits));
+    return _mm256_or_si256(_mm256_slli_epi64(horizontal, 8),
+                           _mm256_srli_epi64(horizontal, 8));
+  };
+  // Per-lane popcount: look up the bit count of each nibble and let the sum
+  // of absolute differences add up the eight bytes of every lane.
+  const __m256i nibble_counts = _mm256_setr_epi8(
+      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3,
+      1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+  const auto popcount = [&](__m256i bits) {
+    const __m256i low = _mm256_and_si256(bits, low_nibbles);
+    const __m256i high =
+        _mm256_and_si256(_mm256_srli_epi16(bits, 4), low_nibbles);
+    return _mm256_sad_epu8(
+        _mm256_add_epi8(_mm256_shuffle_epi8(nibble_counts, low),
+                        _mm256_shuffle_epi8(nibble_counts, high)),
+        _mm256_setzero_si256());
+  };
+
+  const __m256i vtile =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tiles[0]));
+  const __m256i otile =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tiles[1]));
+  const __m256i vblocked = _mm256_or_si256(inflate(vtile), otile);
+  const __m256i oblocked = _mm256_or_si256(inflate(otile), vtile);
+  __m256i vinfl = _mm256_andnot_si256(vblocked, diagonal(vtile));
+  __m256i oinfl = _mm256_andnot_si256(oblocked, diagonal(otile));
+  for (int distance = 0; distance < 2; distance++) {
+    vinfl = _mm256_andnot_si256(vblocked, inflate(vinfl));
+    oinfl = _mm256_andnot_si256(oblocked, inflate(oinfl));
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(influence),
+                      _mm256_sub_epi64(popcount(vinfl), popcount(oinfl)));
+}
+#endif
+
+#if defined(__AVX512BW__) && defined(__AVX512VPOPCNTDQ__) && defined(__GNUC__)
+// GCC 12 warns that the AVX-512 kernel uses uninitialized values: some
+// intrinsics, such as _mm512_shuffle_i64x2() and _mm512_andnot_si512(), pass
+// an undefined vector as the unused source of a masked builtin.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// The Standard influence term for the board with the given rows of each
+// player: the influence of violet minus that of orange, counting only the
+// players whose bit is set in `players`. Bits above XSIZE are ignored.
+//
+// A player's influence is the number of open cells they may reach. Cells
+// that are occupied or share an edge with one of their tiles are blocked;
+// every unblocked diagonal neighbor of their tiles (or the starting point
+// before their first move) is a seed, and the influence covers the seeds and
+// the cells reachable from them in at most three orthogonal steps through
+// unblocked cells. Each implementation below runs this flood fill on a
+// different packed board representation.
+int standard_influence(const uint16_t (&rows)[2][BlokusDuoStandard::YSIZE],
+                       unsigned players) {
+#if defined(__AVX512BW__) && defined(__AVX512VPOPCNTDQ__)
+  // Hold both players in one 512-bit register: violet's rows in 16-bit slots
+  // 0-13 and orange's in slots 16-29, each followed by two zero padding
+  // slots. Word shifts move horizontally, and word permutations move whole
+  // rows vertically; the padding keeps the two boards from touching, so both
+  // flood fills run in the same instructions.
+  constexpr auto WORD_INDEX = [](int offset, int gap) {
+    std::array<uint16_t, 32> index = {};
+    for (int i = 0; i < 32; i++)
+      index[i] = (i + offset + 32) % 32 - (i >= 16 ? gap : 0);
+    return index;
+  };
+  // Moves the rows of both players into their halves of the register.
+  static constexpr std::array<uint16_t, 32> SPREAD = WORD_INDEX(0, 2);
+  // Slot i takes slot i - 1 or i + 1. Slots wrapping around the register
+  // take a padding slot or land in one.
+  static constexpr std::array<uint16_t, 32> ROW_ABOVE = WORD_INDEX(-1, 0);
+  static constexpr std::array<uint16_t, 32> ROW_BELOW = WORD_INDEX(1, 0);
+  const __m512i spread = _mm512_loadu_si512(SPREAD.data());
+  const __m512i row_above = _mm512_loadu_si512(ROW_ABOVE.data());
+  const __m512i row_below = _mm512_loadu_si512(ROW_BELOW.data());
+  const __m512i board_mask = _mm512_maskz_set1_epi16(0x3fff3fff, 0x3fff);
+
+  const auto vertical_neighbors = [&](const __m512i bits) {
+    return _mm512_or_si512(_mm512_permutexvar_epi16(row_above, bits),
+                           _mm512_permutexvar_epi16(row_below, bits));
+  };
+  const auto orthogonal_neighbors = [&](const __m512i bits) {
+    return _mm512_and_si512(
+        _mm512_or_si512(vertical_neighbors(bits),
+                        _mm512_or_si512(_mm512_slli_epi16(bits, 1),
+                                        _mm512_srli_epi16(bits, 1))),
+        board_mask);
+  };
+  const auto diagonal_neighbors = [&](const __m512i bits) {
+    const __m512i vertical = vertical_neighbors(bits);
+    return _mm512_and_si512(_mm512_or_si512(_mm512_slli_epi16(vertical, 1),
+                                            _mm512_srli_epi16(vertical, 1)),
+                            board_mask);
+  };
+
+  // The two players' 28 rows are contiguous.
+  const __m512i tiles = _mm512_and_si512(
+      _mm512_permutexvar_epi16(spread,
+                               _mm512_maskz_loadu_epi16(0x0fffffff, rows[0])),
+      board_mask);
+  const __m512i opponent_tiles =
+      _mm512_shuffle_i64x2(tiles, tiles, _MM_SHUFFLE(1, 0, 3, 2));
+
+  const __m512i edge = orthogonal_neighbors(tiles);
+  __m512i corner = diagonal_neighbors(tiles);
+  const __mmask8 nonempty_words = _mm512_test_epi64_mask(tiles, tiles);
+  if ((nonempty_words & 0x0f) == 0)
+    corner = _mm512_or_si512(corner,
+                             _mm512_set_epi64(0, 0, 0, 0, 0, 0, 1 << 4, 0));
+  if ((nonempty_words & 0xf0) == 0)
+    corner = _mm512_or_si512(corner,
+                             _mm512_set_epi64(0, 1 << 25, 0, 0, 0, 0, 0, 0));
+
+  const __m512i blocked_without_corner =
+      _mm512_or_si512(_mm512_or_si512(tiles, edge), opponent_tiles);
+  const __m512i traversable = _mm512_andnot_si512(
+      _mm512_or_si512(blocked_without_corner, corner), board_mask);
+  __m512i frontier = _mm512_andnot_si512(blocked_without_corner, corner);
+  __m512i reached = frontier;
+  for (int distance = 0; distance < 3; distance++) {
+    frontier = _mm512_andnot_si512(
+        reached,
+        _mm512_and_si512(orthogonal_neighbors(frontier), traversable));
+    reached = _mm512_or_si512(reached, frontier);
+  }
+
+  const __m512i counts = _mm512_popcnt_epi64(reached);
+  int influence = 0;
+  if (players & 1) influence += _mm512_mask_reduce_add_epi64(0x0f, counts);
+  if (players & 2) influence -= _mm512_mask_reduce_add_epi64(0xf0, counts);
+  return influence;
+#elif defined(__AVX2__)
+  // Pack all 14 rows into one 256-bit register. Each 64-bit lane holds four
+  // 16-bit row slots: 14 board bits followed by two zero padding bits. Shifts
+  // by one move horizontally, shifts by 16 move vertically within a lane, and
+  // 64-bit lane permutations carry rows across lane boundaries. The last
+  // 64-bit lane contains only rows 12 and 13.
+  constexpr uint64_t FOUR_ROWS = 0x3fff3fff3fff3fff;
+  const __m256i board_mask = _mm256_set_epi64x(
+      0x000000003fff3fff, FOUR_ROWS, FOUR_ROWS, FOUR_ROWS);
+  const __m256i no_low_word =
+      _mm256_set_epi64x(-1, -1, -1, 0);
+  const __m256i no_high_word =
+      _mm256_set_epi64x(0, -1, -1, -1);
+
+  const auto vertical_neighbors = [&](const __m256i bits) {
+    const __m256i previous_words = _mm256_and_si256(
+        _mm256_permute4x64_epi64(bits, _MM_SHUFFLE(2, 1, 0, 0)),
+        no_low_word);
+    const __m256i next_words = _mm256_and_si256(
+        _mm256_permute4x64_epi64(bits, _MM_SHUFFLE(3, 3, 2, 1)),
+        no_high_word);
+    return _mm256_or_si256(
+        _mm256_or_si256(_mm256_srli_epi64(bits, 16),
+                        _mm256_slli_epi64(bits, 16)),
+        _mm256_or_si256(_mm256_srli_epi64(previous_words, 48),
+                        _mm256_slli_epi64(next_words, 48)));
+  };
+  const auto orthogonal_neighbors = [&](const __m256i bits) {
+    return _mm256_and_si256(
+        _mm256_or_si256(
+            vertical_neighbors(bits),
+            _mm256_or_si256(_mm256_slli_epi64(bits, 1),
+                            _mm256_srli_epi64(bits, 1))),
+        board_mask);
+  };
+  const auto diagonal_neighbors = [&](const __m256i bits) {
+    const __m256i vertical = vertical_neighbors(bits);
+    return _mm256_and_si256(
+        _mm256_or_si256(_mm256_slli_epi64(vertical, 1),
+                        _mm256_srli_epi64(vertical, 1)),
+        board_mask);
+  };
+
+  __m256i tiles[2];
+  for (int player = 0; player < 2; player++) {
+    // Loading rows 6-13 lets the shift zero-pad the upper lane.
+    const __m128i first_eight = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(rows[player]));
+    const __m128i last_eight = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(rows[player] + 6));
+    const __m128i last_six = _mm_srli_si128(last_eight, 4);
+    tiles[player] = _mm256_and_si256(
+        _mm256_inserti128_si256(_mm256_castsi128_si256(first_eight),
+                                last_six, 1),
+        board_mask);
+  }
+
+  // Both players advance in lockstep so that their independent dependency
+  // chains overlap in the pipeline.
+  __m256i frontier[2], reached[2], traversable[2];
+  for (int player = 0; player < 2; player++) {
+    if (!(players >> player & 1)) continue;
+    const __m256i edge = orthogonal_neighbors(tiles[player]);
+    __m256i corner = diagonal_neighbors(tiles[player]);
+    if (_mm256_testz_si256(tiles[player], tiles[player])) {
+      const __m256i start =
+          player == 0
+              ? _mm256_set_epi64x(0, 0, uint64_t{1} << 4, 0)
+              : _mm256_set_epi64x(0, uint64_t{1} << 25, 0, 0);
+      corner = _mm256_or_si256(corner, start);
+    }
+
+    const __m256i blocked_without_corner = _mm256_or_si256(
+        _mm256_or_si256(tiles[player], edge), tiles[1 - player]);
+    const __m256i blocked =
+        _mm256_or_si256(blocked_without_corner, corner);
+    frontier[player] =
+        _mm256_andnot_si256(blocked_without_corner, corner);
+    reached[player] = frontier[player];
+    traversable[player] = _mm256_andnot_si256(blocked, board_mask);
+  }
+
+  for (int distance = 0; distance < 3; distance++) {
+    for (int player = 0; player < 2; player++) {
+      if (!(players >> player & 1)) continue;
+      const __m256i adjacent = orthogonal_neighbors(frontier[player]);
+      frontier[player] = _mm256_andnot_si256(
+          reached[player], _mm256_and_si256(adjacent, traversable[player]));
+      reached[player] = _mm256_or_si256(reached[player], frontier[player]);
+    }
+  }
+
+  int influence[2] = {};
+  for (int player = 0; player < 2; player++) {
+    if (!(players >> player & 1)) continue;
+#if defined(__AVX512VPOPCNTDQ__) && defined(__AVX512VL__)
+    // Use vector popcount when the AVX-512 extension is available for 256-bit
+    // registers; otherwise store the four words and count them scalarly.
+    const __m256i counts = _mm256_popcnt_epi64(reached[player]);
+    const __m128i pair_sums =
+        _mm_add_epi64(_mm256_castsi256_si128(counts),
+                      _mm256_extracti128_si256(counts, 1));
+    influence[player] =
+        _mm_cvtsi128_si64(pair_sums) + _mm_extract_epi64(pair_sums, 1);
+#else
+    alignas(32) uint64_t words[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(words), reached[player]);
+    for (uint64_t word : words) influence[player] += popcount64(word);
+#endif
+  }
+  return influence[0] - influence[1];
+#elif defined(__ARM_NEON) || defined(__wasm_simd128__)
+  // Each 16-bit lane represents one 14-bit board row, so rows 0-7 occupy
+  // `low` and rows 8-13 occupy the first six lanes of `high`; its last two
+  // lanes are masked out. Per-lane bit shifts move horizontally, while vextq
+  // shifts whole rows and carries them between the two registers. Emscripten
+  // maps these 128-bit NEON intrinsics to WebAssembly SIMD.
+  struct SimdRows {
+    uint16x8_t low;
+    uint16x8_t high;
+  };
+
+  const uint16x8_t zeros = vdupq_n_u16(0);
+  uint16x8_t high_mask = vdupq_n_u16(0x3fff);
+  high_mask = vsetq_lane_u16(0, high_mask, 6);
+  high_mask = vsetq_lane_u16(0, high_mask, 7);
+  const SimdRows board_mask = {
+      vdupq_n_u16(0x3fff),
+      high_mask};
+
+  const auto vertical_neighbors = [zeros](const SimdRows& rows) {
+    const uint16x8_t previous_low = vextq_u16(zeros, rows.low, 7);
+    const uint16x8_t next_low = vextq_u16(rows.low, rows.high, 1);
+    const uint16x8_t previous_high = vextq_u16(rows.low, rows.high, 7);
+    const uint16x8_t next_high = vextq_u16(rows.high, zeros, 1);
+    return SimdRows{vorrq_u16(previous_low, next_low),
+                    vorrq_u16(previous_high, next_high)};
+  };
+  const auto orthogonal_neighbors =
+      [&board_mask, &vertical_neighbors](const SimdRows& rows) {
+        const SimdRows vertical = vertical_neighbors(rows);
+        return SimdRows{
+            vandq_u16(
+                vorrq_u16(vertical.low,
+                          vorrq_u16(vshlq_n_u16(rows.low, 1),
+                                    vshrq_n_u16(rows.low, 1))),
+                board_mask.low),
+            vandq_u16(
+                vorrq_u16(vertical.high,
+                          vorrq_u16(vshlq_n_u16(rows.high, 1),
+                                    vshrq_n_u16(rows.high, 1))),
+                board_mask.high)};
+      };
+  const auto diagonal_neighbors =
+      [&board_mask, &vertical_neighbors](const SimdRows& rows) {
+        const SimdRows vertical = vertical_neighbors(rows);
+        return SimdRows{
+            vandq_u16(
+                vorrq_u16(vshlq_n_u16(vertical.low, 1),
+                          vshrq_n_u16(vertical.low, 1)),
+                board_mask.low),
+            vandq_u16(
+                vorrq_u16(vshlq_n_u16(vertical.high, 1),
+                          vshrq_n_u16(vertical.high, 1)),
+                board_mask.high)};
+      };
+
+  SimdRows tiles[2];
+  for (int player = 0; player < 2; player++) {
+    const uint16x8_t first_eight = vld1q_u16(rows[player]);
+    // Start at row 6 so the load stays within the 14-row array, then discard
+    // its first two rows and shift zeros into the unused positions.
+    const uint16x8_t last_eight = vld1q_u16(rows[player] + 6);
+    const uint16x8_t last_six = vextq_u16(last_eight, zeros, 2);
+    tiles[player] = {
+        vandq_u16(first_eight, board_mask.low),
+        vandq_u16(last_six, board_mask.high)};
+  }
+
+  int influence[2] = {};
+  for (int player = 0; player < 2; player++) {
+    if (!(players >> player & 1)) continue;
+    const SimdRows edge = orthogonal_neighbors(tiles[player]);
+    SimdRows corner = diagonal_neighbors(tiles[player]);
+    const uint64x2_t tile_words =
+        vreinterpretq_u64_u16(vorrq_u16(tiles[player].low,
+                                        tiles[player].high));
+    if ((vgetq_lane_u64(tile_words, 0) |
+         vgetq_lane_u64(tile_words, 1)) == 0) {
+      if (player == 0) {
+        corner.low = vsetq_lane_u16(
+            vgetq_lane_u16(corner.low, 4) | (uint16_t{1} << 4),
+            corner.low, 4);
+      } else {
+        corner.high = vsetq_lane_u16(
+            vgetq_lane_u16(corner.high, 1) | (uint16_t{1} << 9),
+            corner.high, 1);
+      }
+    }
+
+    const SimdRows blocked_without_corner = {
+        vorrq_u16(vorrq_u16(tiles[player].low, edge.low),
+                  tiles[1 - player].low),
+        vorrq_u16(vorrq_u16(tiles[player].high, edge.high),
+                  tiles[1 - player].high)};
+    const SimdRows blocked = {
+        vorrq_u16(blocked_without_corner.low, corner.low),
+        vorrq_u16(blocked_without_corner.high, corner.high)};
+    SimdRows frontier = {
+        vbicq_u16(corner.low, blocked_without_corner.low),
+        vbicq_u16(corner.high, blocked_without_corner.high)};
+    SimdRows reached = frontier;
+    const SimdRows traversable = {
+        vbicq_u16(board_mask.low, blocked.low),
+        vbicq_u16(board_mask.high, blocked.high)};
+
+    for (int distance = 0; distance < 3; distance++) {
+      const SimdRows adjacent = orthogonal_neighbors(frontier);
+      frontier = {
+          vbicq_u16(vandq_u16(adjacent.low, traversable.low), reached.low),
+          vbicq_u16(vandq_u16(adjacent.high, traversable.high), reached.high)};
+      reached = {vorrq_u16(reached.low, frontier.low),
+                 vorrq_u16(reached.high, frontier.high)};
+    }
+
+    // Emscripten's NEON compatibility implementation scalarizes vcntq_u8.
+    // Clang's elementwise popcount builtin lowers to the same native NEON
+    // instruction and directly to i8x16.popcnt in WebAssembly.
+#if defined(__clang__)
+    const uint8x16_t byte_counts = vaddq_u8(
+        __builtin_elementwise_popcount(
+            vreinterpretq_u8_u16(reached.low)),
+        __builtin_elementwise_popcount(
+            vreinterpretq_u8_u16(reached.high)));
+#else
+    const uint8x16_t byte_counts = vaddq_u8(
+        vcntq_u8(vreinterpretq_u8_u16(reached.low)),
+        vcntq_u8(vreinterpretq_u8_u16(reached.high)));
+#endif
+    const uint16x8_t pair_counts = vpaddlq_u8(byte_counts);
+    const uint32x4_t quad_counts = vpaddlq_u16(pair_counts);
+    const uint64x2_t half_counts = vpaddlq_u32(quad_counts);
+    influence[player] = vgetq_lane_u64(half_counts, 0) +
+                        vgetq_lane_u64(half_counts, 1);
+  }
+  return influence[0] - influence[1];
+#else
+  // Use the same four-word packing as the AVX2 branch, but operate on scalar
+  // 64-bit values. Each word holds four 16-bit row slots with two padding bits
+  // per row; explicit neighboring-word terms carry vertical shifts across
+  // word boundaries.
+  using Bits = std::array<uint64_t, 4>;
+  constexpr uint64_t FOUR_ROWS = 0x3fff3fff3fff3fff;
+  constexpr Bits BOARD_MASK = {
+      FOUR_ROWS, FOUR_ROWS, FOUR_ROWS, 0x000000003fff3fff};
+
+  const auto orthogonal_neighbors = [&BOARD_MASK](const Bits& bits) {
+    Bits result;
+    for (int word = 0; word < 4; word++) {
+      const uint64_t vertical =
+          (bits[word] >> 16) | (bits[word] << 16) |
+          (word > 0 ? bits[word - 1] >> 48 : 0) |
+          (word < 3 ? bits[word + 1] << 48 : 0);
+      result[word] =
+          ((bits[word] << 1) | (bits[word] >> 1) | vertical) &
+          BOARD_MASK[word];
+    }
+    return result;
+  };
+  const auto diagonal_neighbors = [&BOARD_MASK](const Bits& bits) {
+    Bits result;
+    for (int word = 0; word < 4; word++) {
+      const uint64_t vertical =
+          (bits[word] >> 16) | (bits[word] << 16) |
+          (word > 0 ? bits[word - 1] >> 48 : 0) |
+          (word < 3 ? bits[word + 1] << 48 : 0);
+      result[word] = ((vertical << 1) | (vertical >> 1)) & BOARD_MASK[word];
+    }
+    return result;
+  };
+
+  Bits tiles[2] = {};
+  for (int player = 0; player < 2; player++) {
+    for (int y = 0; y < BlokusDuoStandard::YSIZE; y++) {
+      tiles[player][y / 4] |=
+          static_cast<uint64_t>(rows[player][y] & 0x3fff) << (y % 4 * 16);
+    }
+  }
+
+  int influence[2] = {};
+  for (int player = 0; player < 2; player++) {
+    if (!(players >> player & 1)) continue;
+    Bits edge = orthogonal_neighbors(tiles[player]);
+    Bits corner = diagonal_neighbors(tiles[player]);
+    bool has_tiles = false;
+    for (uint64_t word : tiles[player]) has_tiles |= word != 0;
+    if (!has_tiles) {
+      const int x = player == 0 ? BlokusDuoStandard::START1X
+                                : BlokusDuoStandard::START2X;
+      const int y = player == 0 ? BlokusDuoStandard::START1Y
+                                : BlokusDuoStandard::START2Y;
+      corner[y / 4] |= uint64_t{1} << (y % 4 * 16 + x);
+    }
+
+    Bits traversable;
+    Bits reached;
+    Bits frontier;
+    for (int word = 0; word < 4; word++) {
+      const uint64_t blocked =
+          tiles[player][word] | edge[word] | corner[word] |
+          tiles[1 - player][word];
+      frontier[word] =
+          corner[word] &
+          ~(tiles[player][word] | edge[word] | tiles[1 - player][word]);
+      reached[word] = frontier[word];
+      traversable[word] = ~blocked & BOARD_MASK[word];
+    }
+
+    for (int distance = 0; distance < 3; distance++) {
+      const Bits adjacent = orthogonal_neighbors(frontier);
+      for (int word = 0; word < 4; word++) {
+        frontier[word] = adjacent[word] & traversable[word] & ~reached[word];
+        reached[word] |= frontier[word];
+      }
+    }
+    for (uint64_t word : reached) influence[player] += popcount64(word);
+  }
+  return influence[0] - influence[1];
+#endif
+}
+
+#if defined(__AVX512BW__) && defined(__AVX512VPOPCNTDQ__) && defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+#if defined(__AVX512BW__) && defined(__AVX512VL__)
+// Each AND or OR tests one cell of the piece at every position of the board.
+bool placements(const uint16_t* open_rows, const uint16_t* anchor_rows,
+                const uint8_t* rows, int height, uint16_t* positions) {
+  const __m256i open =
+      _mm256_load_si256(reinterpret_cast<const __m256i*>(open_rows));
+  const __m256i anchors =
+      _mm256_load_si256(reinterpret_cast<const __m256i*>(anchor_rows));
+  const __m256i word_index = _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+                                               10, 11, 12, 13, 14, 15);
+  __m256i fits = _mm256_set1_epi16(-1);
+  __m256i touches = _mm256_setzero_si256();
+  for (int row = 0; row < height; row++) {
+    // Rows y + row of `open` and `anchors`, moved to row y.
+    const __mmask16 in_board = 0xffff >> row;
+    const __m256i index =
+        _mm256_add_epi16(word_index, _mm256_set1_epi16(row));
+    const __m256i open_below =
+        _mm256_maskz_permutexvar_epi16(in_board, index, open);
+    const __m256i anchors_below =
+        _mm256_maskz_permutexvar_epi16(in_board, index, anchors);
+    for (unsigned cells = rows[row]; cells != 0; cells &= cells - 1) {
+      const __m128i x = _mm_cvtsi32_si128(countr_zero32(cells));
+      fits = _mm256_and_si256(fits, _mm256_srl_epi16(open_below, x));
+      touches = _mm256_or_si256(touches, _mm256_srl_epi16(anchors_below, x));
+    }
+  }
+  const __m256i valid = _mm256_and_si256(fits, touches);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(positions), valid);
+  return !_mm256_testz_si256(valid, valid);
+}
+#else
+// Each AND or OR tests one cell of the piece at every position of a row, and
+// the loops over the rows vectorize with any SIMD instructions available.
+bool placements(const uint16_t* open, const uint16_t* anchors,
+                const uint8_t* rows, int height, uint16_t* positions) {
+  uint16_t fits[16], touches[16] = {};
+  for (int y = 0; y < 16; y++) fits[y] = y + height <= 16 ? 0xffff : 0;
+  for (int row = 0; row < height; row++) {
+    for (unsigned cells = rows[row]; cells != 0; cells &= cells - 1) {
+      const int x = countr_zero32(cells);
+      for (int y = 0; y + row < 16; y++) {
+        fits[y] &= open[y + row] >> x;
+        touches[y] |= anchors[y + row] >> x;
+      }
+    }
+  }
+  uint16_t any = 0;
+  for (int y = 0; y < 16; y++) {
+    positions[y] = fits[y] & touches[y];
+    any |= positions[y];
+  }
+  return any != 0;
+}
+#endif
+
+}  // namespace
+}  // namespace BLOKUSDUO_KERNELS
+
+extern const Kernels BLOKUSDUO_CONCAT(kernels_, BLOKUSDUO_KERNELS) = {
+    .name = BLOKUSDUO_STRING(BLOKUSDUO_KERNELS),
+    .standard_influence = &BLOKUSDUO_KERNELS::standard_influence,
+    .mini_influence = &BLOKUSDUO_KERNELS::mini_influence,
+#if defined(__AVX2__)
+    .mini_influence_x4 = &BLOKUSDUO_KERNELS::mini_influence_x4,
+#else
+    .mini_influence_x4 = nullptr,
+#endif
+    .placements = &BLOKUSDUO_KERNELS::placements,
+};
+
+}  // namespace blokusduo
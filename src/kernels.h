@@ -0,0 +1,62 @@
+#ifndef KERNELS_H_
+#define KERNELS_H_
+
+#include <stdint.h>
+
+#include <string_view>
+#include <vector>
+
+#include "blokusduo.h"
+
+namespace blokusduo {
+
+// The board routines with versions for several instruction sets. kernels.cpp
+// defines one set per build of it: with BLOKUSDUO_ENABLE_DISPATCH, it is
+// built once each for baseline x86-64, AVX2 and AVX-512, and the most capable
+// set the CPU supports is picked at startup; otherwise it is built once with
+// the library's own flags.
+struct Kernels {
+  const char* name;
+
+  // The Standard influence term for the board with the given rows of each
+  // player, counting only the players whose bit is set in `players`. Bits
+  // above XSIZE are ignored.
+  int (*standard_influence)(const uint16_t (&rows)[2][BlokusDuoStandard::YSIZE],
+                            unsigned players);
+
+  // The Mini influence term for a board whose rows are packed into one
+  // 64-bit word per player, row y in byte y.
+  int (*mini_influence)(const uint64_t (&tiles)[2], unsigned players);
+
+  // Stores the Mini influence of four boards, lane i of each player's tiles
+  // in influence[i]. Null if the set has no vector version.
+  void (*mini_influence_x4)(const uint64_t (&tiles)[2][4],
+                            int64_t (&influence)[4]);
+
+  // Stores the positions at which a piece can be placed in `positions`, one
+  // row per word: bit x of word y is set if, with the top-left corner of its
+  // bounding box at (x, y), every cell of the piece is in `open` and at least
+  // one is in `anchors`. `rows` are the `height` rows of the piece, and each
+  // array of 16 words is 32-byte aligned, zero below the board. Returns false
+  // if there are no such positions.
+  bool (*placements)(const uint16_t* open, const uint16_t* anchors,
+                     const uint8_t* rows, int height, uint16_t* positions);
+};
+
+extern const Kernels* active_kernels;
+
+// Returns the kernels in use. The BLOKUSDUO_KERNELS environment variable
+// overrides the choice at startup with the name of a set.
+inline const Kernels& kernels() { return *active_kernels; }
+
+// Returns the kernel sets built into the library that this CPU can run, the
+// most capable first.
+std::vector<const Kernels*> supported_kernels();
+
+// Switches to the supported kernel set called `name`. Returns false, keeping
+// the current set, if there is none.
+bool use_kernels(std::string_view name);
+
+}  // namespace blokusduo
+
+#endif  // KERNELS_H_
@@ -0,0 +1,407 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "blokusduo.h"
+#include "blokusduo_mcts.h"
+#include "search_move.h"
+
+namespace blokusduo::search {
+namespace {
+
+// An engine configuration, parsed from comma-separated key=value pairs:
+//   mcts=1        use MCTS instead of NegaScout
+//   auto=1        use auto_search() with time= (default 1) instead of the
+//                 turn-based staging
+//   depth=N       NegaScout depth; default: MoveSchedule::depth()
+//   time=S        seconds per move: a soft limit for NegaScout's iterative
+//                 deepening, and a hard limit for MCTS
+//   playouts=N    MCTS playouts per move; default 10000 without time=
+//   probcut=0|1   NegaScout ProbCut
+//   lazy=0|1      NegaScout lazy evaluation at the horizon
+//   lmr=N         NegaScout late move reductions after N moves; 0: off
+//   multicut=0|1  NegaScout multi-cut
+//   etc=0|1       NegaScout enhanced transposition cutoffs
+//   wld=T         first turn of win/loss/draw search
+//   perfect=T     first turn of perfect search
+struct EngineConfig {
+  std::string spec;
+  bool mcts = false;
+  bool auto_search = false;
+  int depth = 0;
+  double seconds = 0;
+  long playouts = 0;
+  bool probcut = true;
+  bool lazy_eval = SearchOptions<BlokusDuoStandard>().lazy_eval;
+  int lmr_moves = SearchOptions<BlokusDuoStandard>().lmr_moves;
+  bool multi_cut = SearchOptions<BlokusDuoStandard>().multi_cut;
+  bool etc = SearchOptions<BlokusDuoStandard>().etc;
+  int wld_turn = -1;
+  int perfect_turn = -1;
+};
+
+struct Options {
+  bool mini = false;
+  int games = 1000;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  int opening_plies = -1;  // Default: 4 for Standard, 2 for Mini.
+  double opening_temperature = 2;
+  uint64_t seed = 1;
+  double elo0 = 0, elo1 = 5;
+  double alpha = 0.05, beta = 0.05;
+  // The SPRT does not stop the match before this many games, since its
+  // variance estimate is unreliable for the first few.
+  int min_games = 16;
+  EngineConfig engines[2];
+};
+
+struct EngineStats {
+  long moves = 0;
+  long nodes = 0;
+  double seconds = 0;
+  double max_seconds = 0;
+};
+
+double elapsed_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+template <class Game>
+class Player {
+ public:
+  Player(const EngineConfig& config, const BoardImpl<Game>& board)
+      : config_(config) {
+    options_.probcut = config.probcut;
+    options_.lazy_eval = config.lazy_eval;
+    options_.lmr_moves = config.lmr_moves;
+    options_.multi_cut = config.multi_cut;
+    options_.etc = config.etc;
+    if (config.mcts) mcts_ = std::make_unique<Mcts<Game>>(board);
+  }
+
+  Move choose_move(const BoardImpl<Game>& board) {
+    if (config_.auto_search) {
+      return auto_search(board,
+                         {.seconds = config_.seconds > 0 ? config_.seconds : 1,
+                          .negascout = options_})
+          .first;
+    }
+    using Schedule = MoveSchedule<Game>;
+    const int perfect_turn = config_.perfect_turn >= 0
+                                 ? config_.perfect_turn
+                                 : Schedule::PERFECT_TURN;
+    const int wld_turn =
+        config_.wld_turn >= 0 ? config_.wld_turn : Schedule::WLD_TURN;
+    if (board.turn() >= perfect_turn) return perfect(board).first;
+    if (board.turn() >= wld_turn) return wld(board).first;
+
+    if (mcts_) {
+      const long playouts =
+          config_.playouts > 0 || config_.seconds > 0 ? config_.playouts
+                                                      : 10000;
+      return mcts_->search(playouts, config_.seconds).first;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const int depth = config_.depth > 0    ? config_.depth
+                      : config_.seconds > 0 ? 20
+                                            : Schedule::depth(board.turn());
+    return negascout(
+               board, std::max(depth, 2),
+               [&](int, SearchResult) {
+                 // The next iteration takes at least as long again.
+                 return config_.seconds <= 0 ||
+                        elapsed_since(start) < config_.seconds / 2;
+               },
+               options_)
+        .first;
+  }
+
+  void play_move(Move move) {
+    if (mcts_) mcts_->advance(move);
+  }
+
+ private:
+  const EngineConfig& config_;
+  SearchOptions<Game> options_;
+  std::unique_ptr<Mcts<Game>> mcts_;
+};
+
+// Plays the opening of a game pair with randomized shallow searches.
+template <class Game>
+std::vector<Move> make_opening(const Options& options, uint64_t seed) {
+  const int plies = options.opening_plies >= 0 ? options.opening_plies
+                    : std::is_same_v<Game, BlokusDuoMini> ? 2
+                                                           : 4;
+  std::vector<Move> moves;
+  BoardImpl<Game> board;
+  for (int ply = 0; ply < plies && !board.is_game_over(); ply++) {
+    const Move move =
+        negascout_gumbel(board, 2, options.opening_temperature,
+                         mix_seed(seed + ply),
+                         [](int, SearchResult) { return true; })
+            .first;
+    moves.push_back(move);
+    board.play_move(move);
+  }
+  return moves;
+}
+
+// Plays one game and returns the final score difference for engine 0.
+template <class Game>
+int play_game(const Options& options, const std::vector<Move>& opening,
+              int first_player, EngineStats stats[2]) {
+  BoardImpl<Game> board;
+  for (Move move : opening) board.play_move(move);
+  Player<Game> players[2] = {Player<Game>(options.engines[0], board),
+                             Player<Game>(options.engines[1], board)};
+  while (!board.is_game_over()) {
+    // Engine 0 plays violet if first_player is 0.
+    const int engine = board.player() ^ first_player;
+    const auto start = std::chrono::steady_clock::now();
+    visited_nodes = 0;
+    const Move move = players[engine].choose_move(board);
+    const double seconds = elapsed_since(start);
+    stats[engine].moves++;
+    stats[engine].nodes += visited_nodes;
+    stats[engine].seconds += seconds;
+    stats[engine].max_seconds = std::max(stats[engine].max_seconds, seconds);
+
+    board.play_move(move);
+    for (Player<Game>& player : players) player.play_move(move);
+  }
+  const int difference = board.score(0) - board.score(1);
+  return first_player == 0 ? difference : -difference;
+}
+
+double expected_score(double elo) {
+  return 1 / (1 + std::pow(10, -elo / 400));
+}
+
+double elo_of(double score) {
+  score = std::clamp(score, 1e-6, 1 - 1e-6);
+  return -400 * std::log10(1 / score - 1);
+}
+
+struct Tally {
+  int wins = 0, draws = 0, losses = 0;
+
+  int games() const { return wins + draws + losses; }
+  double score() const { return (wins + 0.5 * draws) / games(); }
+  // Variance of the result of one game.
+  double variance() const {
+    const double s = score();
+    return (wins * (1 - s) * (1 - s) + draws * (0.5 - s) * (0.5 - s) +
+            losses * s * s) /
+           games();
+  }
+  // 95% confidence interval of the Elo difference.
+  std::pair<double, double> elo_interval() const {
+    const double margin = 1.96 * std::sqrt(variance() / games());
+    return {elo_of(score() - margin), elo_of(score() + margin)};
+  }
+  // Log-likelihood ratio of H1 (elo1) against H0 (elo0), in the normal
+  // approximation of the generalized SPRT.
+  double llr(double elo0, double elo1) const {
+    const double var = variance();
+    if (var <= 0) return 0;
+    const double s0 = expected_score(elo0), s1 = expected_score(elo1);
+    return games() * (s1 - s0) * (2 * score() - s0 - s1) / (2 * var);
+  }
+};
+
+template <class Game>
+int run(const Options& options) {
+  const double lower = std::log(options.beta / (1 - options.alpha));
+  const double upper = std::log((1 - options.beta) / options.alpha);
+
+  std::atomic<int> next_game = 0;
+  std::atomic<bool> stop = false;
+  std::mutex mutex;  // Guards the tally, the stats, and the output.
+  Tally tally;
+  EngineStats totals[2];
+  const char* decision = nullptr;
+
+  const auto worker = [&] {
+    for (int i; !stop && (i = next_game++) < options.games;) {
+      // Each pair of games shares an opening, with colors swapped.
+      const uint64_t pair_seed = mix_seed(options.seed + i / 2);
+      const std::vector<Move> opening = make_opening<Game>(options, pair_seed);
+      EngineStats stats[2];
+      const int difference = play_game<Game>(options, opening, i % 2, stats);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      for (int e = 0; e < 2; e++) {
+        totals[e].moves += stats[e].moves;
+        totals[e].nodes += stats[e].nodes;
+        totals[e].seconds += stats[e].seconds;
+        totals[e].max_seconds =
+            std::max(totals[e].max_seconds, stats[e].max_seconds);
+      }
+      if (difference > 0)
+        tally.wins++;
+      else if (difference == 0)
+        tally.draws++;
+      else
+        tally.losses++;
+      const auto [elo_low, elo_high] = tally.elo_interval();
+      const double llr = tally.llr(options.elo0, options.elo1);
+      printf(
+          "game %d: A plays %s, %+d; A %d-%d-%d, score %.3f, "
+          "Elo %+.1f [%+.1f, %+.1f], LLR %.2f [%.2f, %.2f]\n",
+          i + 1, i % 2 ? "orange" : "violet", difference, tally.wins,
+          tally.draws, tally.losses, tally.score(), elo_of(tally.score()),
+          elo_low, elo_high, llr, lower, upper);
+      fflush(stdout);
+      if (!decision && tally.games() >= options.min_games &&
+          (llr <= lower || llr >= upper)) {
+        decision = llr >= upper ? "H1 accepted" : "H0 accepted";
+        stop = true;
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < options.threads; i++) threads.emplace_back(worker);
+  for (std::thread& thread : threads) thread.join();
+
+  if (tally.games() == 0) return 1;
+  const auto [elo_low, elo_high] = tally.elo_interval();
+  printf("\nA: %s\nB: %s\n", options.engines[0].spec.c_str(),
+         options.engines[1].spec.c_str());
+  printf("%d games: A %d wins, %d draws, %d losses, score %.3f\n",
+         tally.games(), tally.wins, tally.draws, tally.losses, tally.score());
+  printf("Elo difference %+.1f, 95%% interval [%+.1f, %+.1f]\n",
+         elo_of(tally.score()), elo_low, elo_high);
+  printf("SPRT elo0=%g elo1=%g: LLR %.2f [%.2f, %.2f], %s\n", options.elo0,
+         options.elo1, tally.llr(options.elo0, options.elo1), lower, upper,
+         decision ? decision : "inconclusive");
+  for (int e = 0; e < 2; e++) {
+    const EngineStats& s = totals[e];
+    printf("%c: %.3f sec/move (max %.3f), %.0f nodes/sec\n", 'A' + e,
+           s.seconds / s.moves, s.max_seconds, s.nodes / s.seconds);
+  }
+  return 0;
+}
+
+void usage(const char* program) {
+  fprintf(stderr,
+          "Usage: %s [--mini] [--games N] [--threads N] [--seed S]\n"
+          "          [--opening-plies N] [--opening-temperature T]\n"
+          "          [--sprt ELO0:ELO1] [--alpha A] [--beta B]\n"
+          "          [--min-games N]\n"
+          "          --a SPEC --b SPEC\n"
+          "SPEC is a comma-separated list of mcts=0|1, auto=0|1, depth=N,\n"
+          "time=S, playouts=N, probcut=0|1, lazy=0|1, lmr=N, multicut=0|1,\n"
+          "etc=0|1, wld=TURN, and perfect=TURN,\n"
+          "or \"default\" for the staging of search_move().\n",
+          program);
+  exit(2);
+}
+
+bool parse_engine(const char* spec, EngineConfig* config) {
+  config->spec = spec;
+  if (strcmp(spec, "default") == 0) return true;
+  std::string s = spec;
+  for (size_t begin = 0; begin < s.size();) {
+    size_t end = s.find(',', begin);
+    if (end == std::string::npos) end = s.size();
+    const std::string item = s.substr(begin, end - begin);
+    begin = end + 1;
+    const size_t eq = item.find('=');
+    if (eq == std::string::npos) return false;
+    const std::string key = item.substr(0, eq);
+    const char* value = item.c_str() + eq + 1;
+    if (key == "mcts")
+      config->mcts = atoi(value) != 0;
+    else if (key == "auto")
+      config->auto_search = atoi(value) != 0;
+    else if (key == "depth")
+      config->depth = atoi(value);
+    else if (key == "time")
+      config->seconds = atof(value);
+    else if (key == "playouts")
+      config->playouts = atol(value);
+    else if (key == "probcut")
+      config->probcut = atoi(value) != 0;
+    else if (key == "lazy")
+      config->lazy_eval = atoi(value) != 0;
+    else if (key == "lmr")
+      config->lmr_moves = atoi(value);
+    else if (key == "multicut")
+      config->multi_cut = atoi(value) != 0;
+    else if (key == "etc")
+      config->etc = atoi(value) != 0;
+    else if (key == "wld")
+      config->wld_turn = atoi(value);
+    else if (key == "perfect")
+      config->perfect_turn = atoi(value);
+    else
+      return false;
+  }
+  return true;
+}
+
+Options parse_options(int argc, char** argv) {
+  Options options;
+  bool engines[2] = {false, false};
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (strcmp(arg, "--mini") == 0) {
+      options.mini = true;
+      continue;
+    }
+    if (i + 1 >= argc) usage(argv[0]);
+    const char* value = argv[++i];
+    if (strcmp(arg, "--games") == 0) {
+      options.games = atoi(value);
+    } else if (strcmp(arg, "--threads") == 0) {
+      options.threads = std::max(1, atoi(value));
+    } else if (strcmp(arg, "--seed") == 0) {
+      options.seed = strtoull(value, nullptr, 0);
+    } else if (strcmp(arg, "--opening-plies") == 0) {
+      options.opening_plies = atoi(value);
+    } else if (strcmp(arg, "--opening-temperature") == 0) {
+      options.opening_temperature = atof(value);
+    } else if (strcmp(arg, "--sprt") == 0) {
+      if (sscanf(value, "%lf:%lf", &options.elo0, &options.elo1) != 2 ||
+          options.elo0 >= options.elo1)
+        usage(argv[0]);
+    } else if (strcmp(arg, "--alpha") == 0) {
+      options.alpha = atof(value);
+    } else if (strcmp(arg, "--beta") == 0) {
+      options.beta = atof(value);
+    } else if (strcmp(arg, "--min-games") == 0) {
+      options.min_games = atoi(value);
+    } else if (strcmp(arg, "--a") == 0 || strcmp(arg, "--b") == 0) {
+      const int e = arg[2] - 'a';
+      if (!parse_engine(value, &options.engines[e])) usage(argv[0]);
+      engines[e] = true;
+    } else {
+      usage(argv[0]);
+    }
+  }
+  if (!engines[0] || !engines[1]) usage(argv[0]);
+  return options;
+}
+
+}  // namespace
+}  // namespace blokusduo::search
+
+int main(int argc, char** argv) {
+  using namespace blokusduo;
+  const search::Options options = search::parse_options(argc, argv);
+  if (options.mini) return search::run<BlokusDuoMini>(options);
+  return search::run<BlokusDuoStandard>(options);
+}
@@ -0,0 +1,273 @@
+#include <assert.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "blokusduo_mcts.h"
+#include "move_visitors.h"
+
+namespace blokusduo::search {
+
+template <class Game>
+struct Mcts<Game>::Node {
+  explicit Node(Move m = Move(), float p = 1) : move(m), prior(p) {}
+
+  const Move move;
+  const float prior;
+
+  // Statistics from the point of view of the player who played `move`.
+  std::atomic<int> visits = 0;
+  std::atomic<int> virtual_loss = 0;
+  std::atomic<double> value_sum = 0;
+
+  // Set once the fields below are final; they are not modified afterwards.
+  std::atomic<bool> expanded = false;
+  bool terminal = false;
+  double terminal_value = 0;  // For the player to move, if terminal.
+  std::vector<std::unique_ptr<Node>> children;
+
+  std::mutex expand_mutex;
+};
+
+namespace {
+
+template <class Game>
+double game_result(const BoardImpl<Game>& b) {
+  const int score = b.relative_score();
+  return score > 0 ? 1 : score < 0 ? -1 : 0;
+}
+
+}  // namespace
+
+template <class Game>
+class Mcts<Game>::Worker {
+ public:
+  Worker(const Mcts& mcts, uint64_t seed) : mcts_(mcts), random_(seed) {}
+
+  // Runs one selection, expansion, evaluation and backup pass.
+  void playout() {
+    const int virtual_loss = mcts_.options_.virtual_loss;
+    BoardImpl<Game> board = mcts_.board_;
+    path_.clear();
+    Node* node = mcts_.root_.get();
+    path_.push_back(node);
+    double value;  // For the player to move at the leaf.
+    for (;;) {
+      if (!node->expanded.load(std::memory_order_acquire)) {
+        value = expand(node, board);
+        break;
+      }
+      if (node->terminal) {
+        value = node->terminal_value;
+        break;
+      }
+      node = select(node);
+      node->virtual_loss += virtual_loss;
+      board.play_move(node->move);
+      path_.push_back(node);
+    }
+    for (auto i = path_.rbegin(); i != path_.rend(); ++i) {
+      value = -value;
+      (*i)->value_sum += value;
+      (*i)->visits++;
+      if (*i != mcts_.root_.get()) (*i)->virtual_loss -= virtual_loss;
+    }
+  }
+
+ private:
+  Node* select(Node* node) const {
+    const int parent_visits = node->visits + node->virtual_loss;
+    const double sqrt_visits = std::sqrt(std::max(parent_visits, 1));
+    // Unvisited children are valued like their parent.
+    const double first_play_value =
+        node->visits > 0 ? -node->value_sum / node->visits : 0;
+    // Expanded nodes that are not terminal have at least a pass move.
+    assert(!node->children.empty());
+    Node* best = node->children.front().get();
+    double best_score = -INFINITY;
+    for (const auto& child : node->children) {
+      const int visits = child->visits + child->virtual_loss;
+      const double q =
+          visits > 0 ? (child->value_sum - child->virtual_loss) / visits
+                     : first_play_value;
+      const double score = q + mcts_.options_.exploration * child->prior *
+                                   sqrt_visits / (1 + visits);
+      if (score > best_score) {
+        best_score = score;
+        best = child.get();
+      }
+    }
+    return best;
+  }
+
+  // Creates the children of a leaf and returns its value for the player to
+  // move. If another thread expanded the leaf first, it is only evaluated.
+  double expand(Node* node, const BoardImpl<Game>& board) {
+    std::lock_guard<std::mutex> lock(node->expand_mutex);
+    if (node->expanded.load(std::memory_order_relaxed))
+      return node->terminal ? node->terminal_value : evaluate(board);
+
+    if (board.is_game_over()) {
+      node->terminal = true;
+      node->terminal_value = game_result(board);
+      node->expanded.store(true, std::memory_order_release);
+      return node->terminal_value;
+    }
+
+    MoveCollector<Game> collector;
+    board.visit_moves(&collector);
+    std::vector<double> priors;
+    priors.reserve(collector.moves.size());
+    double value;
+    if (mcts_.evaluator_) {
+      // Evaluate the children and the leaf itself in one call.
+      boards_.clear();
+      for (Move move : collector.moves) boards_.push_back(board.child(move));
+      boards_.push_back(board);
+      values_.resize(boards_.size());
+      mcts_.evaluator_->evaluate(boards_, values_);
+      for (size_t i = 0; i < collector.moves.size(); i++)
+        priors.push_back(-values_[i]);
+      value = mcts_.options_.leaf == MctsOptions::EVALUATION
+                  ? leaf_value(values_.back())
+                  : rollout(board);
+    } else {
+      for (Move move : collector.moves)
+        priors.push_back(-board.child(move).nega_eval());
+      value = evaluate(board);
+    }
+    const double max_eval = *std::max_element(priors.begin(), priors.end());
+    double sum = 0;
+    for (double& prior : priors) {
+      prior =
+          std::exp((prior - max_eval) / mcts_.options_.prior_temperature);
+      sum += prior;
+    }
+    node->children.reserve(collector.moves.size());
+    for (size_t i = 0; i < collector.moves.size(); i++) {
+      node->children.push_back(
+          std::make_unique<Node>(collector.moves[i], priors[i] / sum));
+    }
+    node->expanded.store(true, std::memory_order_release);
+    return value;
+  }
+
+  double leaf_value(int eval) const {
+    return std::tanh(eval / mcts_.options_.value_scale);
+  }
+
+  double evaluate(const BoardImpl<Game>& board) {
+    if (mcts_.options_.leaf == MctsOptions::ROLLOUT) return rollout(board);
+    if (!mcts_.evaluator_) return leaf_value(board.nega_eval());
+    int eval;
+    mcts_.evaluator_->evaluate(std::span(&board, 1), std::span(&eval, 1));
+    return leaf_value(eval);
+  }
+
+  double rollout(const BoardImpl<Game>& board) {
+    BoardImpl<Game> b = board;
+    while (!b.is_game_over()) {
+      RandomMoveVisitor<Game> visitor(&random_);
+      b.visit_moves(&visitor);
+      b.play_move(visitor.move);
+    }
+    // The rollout may end with either player to move.
+    const double result = game_result(b);
+    return b.player() == board.player() ? result : -result;
+  }
+
+  const Mcts& mcts_;
+  std::mt19937_64 random_;
+  std::vector<Node*> path_;
+  std::vector<BoardImpl<Game>> boards_;
+  std::vector<int> values_;
+};
+
+template <class Game>
+Mcts<Game>::Mcts(const BoardImpl<Game>& root, const MctsOptions& options,
+                 LeafEvaluator<Game>* evaluator)
+    : board_(root),
+      options_(options),
+      evaluator_(evaluator),
+      root_(std::make_unique<Node>()) {
+  assert(options_.threads >= 1);
+}
+
+template <class Game>
+Mcts<Game>::~Mcts() = default;
+
+template <class Game>
+SearchResult Mcts<Game>::search(long max_playouts, double max_seconds) {
+  assert(max_playouts > 0 || max_seconds > 0);
+  const auto deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(max_seconds));
+  std::atomic<long> started = 0, finished = 0;
+
+  const auto run = [&](uint64_t seed) {
+    Worker worker(*this, seed);
+    long count = 0;
+    while (max_playouts <= 0 || started++ < max_playouts) {
+      worker.playout();
+      count++;
+      if (max_seconds > 0 && std::chrono::steady_clock::now() >= deadline)
+        break;
+    }
+    finished += count;
+  };
+  const uint64_t seed = options_.seed + root_->visits;
+  std::vector<std::thread> threads;
+  for (int i = 1; i < options_.threads; i++)
+    threads.emplace_back(run, seed + i * 0x9e3779b97f4a7c15);
+  run(seed);
+  for (std::thread& thread : threads) thread.join();
+  visited_nodes += finished;
+
+  const Node* best = nullptr;
+  for (const auto& child : root_->children) {
+    if (!best || child->visits > best->visits) best = child.get();
+  }
+  if (!best) return SearchResult(Move(), 0);
+  const double value =
+      best->visits > 0 ? best->value_sum / best->visits : 0;
+  return SearchResult(best->move, std::lround(value * 1000));
+}
+
+template <class Game>
+void Mcts<Game>::advance(Move move) {
+  std::unique_ptr<Node> next;
+  const Move canonical = move.canonicalize();
+  for (auto& child : root_->children) {
+    if (child->move.canonicalize() == canonical) {
+      next = std::move(child);
+      break;
+    }
+  }
+  board_.play_move(move);
+  root_ = next ? std::move(next) : std::make_unique<Node>();
+}
+
+template <class Game>
+long Mcts<Game>::root_visits() const {
+  return root_->visits;
+}
+
+template <class Game>
+std::vector<std::pair<Move, int>> Mcts<Game>::root_visit_counts() const {
+  std::vector<std::pair<Move, int>> counts;
+  for (const auto& child : root_->children)
+    counts.emplace_back(child->move, child->visits);
+  return counts;
+}
+
+template class Mcts<BlokusDuoMini>;
+template class Mcts<BlokusDuoStandard>;
+
+}  // namespace blokusduo::search
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "blokusduo.h"
+#include "blokusduo_mcts.h"
+
+namespace blokusduo::search {
+namespace {
+
+struct Options {
+  bool mini = false;
+  int games = 4;
+  double seconds = 0.5;
+  MctsOptions mcts;
+};
+
+struct Engine {
+  int moves = 0;
+  long nodes = 0;
+  double seconds = 0;
+};
+
+double elapsed_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// Plays one game between MCTS and NegaScout, and returns the final score
+// difference from MCTS's point of view. Both engines get `seconds` per move:
+// MCTS stops at the deadline, and NegaScout does not start a new iteration
+// after half of it, since the next one would take at least as long again.
+template <class Game>
+int play_game(const Options& options, int mcts_player, Engine* mcts_stats,
+              Engine* negascout_stats) {
+  BoardImpl<Game> board;
+  Mcts<Game> mcts(board, options.mcts);
+  while (!board.is_game_over()) {
+    const auto start = std::chrono::steady_clock::now();
+    const bool mcts_turn = board.player() == mcts_player;
+    Engine* stats = mcts_turn ? mcts_stats : negascout_stats;
+    visited_nodes = 0;
+
+    Move move;
+    if (mcts_turn) {
+      move = mcts.search(0, options.seconds).first;
+    } else {
+      move = negascout(board, 20, [&](int, SearchResult) {
+               return elapsed_since(start) < options.seconds / 2;
+             }).first;
+    }
+    stats->moves++;
+    stats->nodes += visited_nodes;
+    stats->seconds += elapsed_since(start);
+
+    board.play_move(move);
+    mcts.advance(move);
+  }
+  const int difference = board.score(0) - board.score(1);
+  return mcts_player == 0 ? difference : -difference;
+}
+
+template <class Game>
+void run(const Options& options) {
+  Engine mcts, negascout;
+  int wins = 0, draws = 0, losses = 0;
+  for (int i = 0; i < options.games; i++) {
+    const int mcts_player = i % 2;
+    const int difference =
+        play_game<Game>(options, mcts_player, &mcts, &negascout);
+    printf("game %d: MCTS plays %s, score difference %+d\n", i + 1,
+           mcts_player == 0 ? "violet" : "orange", difference);
+    fflush(stdout);
+    if (difference > 0)
+      wins++;
+    else if (difference == 0)
+      draws++;
+    else
+      losses++;
+  }
+  printf("MCTS %d wins, %d draws, %d losses against NegaScout\n", wins, draws,
+         losses);
+  const auto report = [](const char* name, const Engine& e,
+                          const char* unit) {
+    printf("%-9s %.3f sec/move, %.0f %s/sec\n", name, e.seconds / e.moves,
+           e.nodes / e.seconds, unit);
+  };
+  report("MCTS", mcts, "playouts");
+  report("NegaScout", negascout, "nodes");
+}
+
+void usage(const char* program) {
+  fprintf(stderr,
+          "Usage: %s [--mini] [--games N] [--seconds S] [--threads N]\n"
+          "          [--rollout]\n",
+          program);
+  exit(2);
+}
+
+Options parse_options(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (strcmp(arg, "--mini") == 0) {
+      options.mini = true;
+      continue;
+    }
+    if (strcmp(arg, "--rollout") == 0) {
+      options.mcts.leaf = MctsOptions::ROLLOUT;
+      continue;
+    }
+    if (i + 1 >= argc) usage(argv[0]);
+    const char* value = argv[++i];
+    if (strcmp(arg, "--games") == 0) {
+      options.games = atoi(value);
+    } else if (strcmp(arg, "--seconds") == 0) {
+      options.seconds = atof(value);
+      if (options.seconds <= 0) usage(argv[0]);
+    } else if (strcmp(arg, "--threads") == 0) {
+      options.mcts.threads = std::max(1, atoi(value));
+    } else {
+      usage(argv[0]);
+    }
+  }
+  return options;
+}
+
+}  // namespace
+}  // namespace blokusduo::search
+
+int main(int argc, char** argv) {
+  using namespace blokusduo;
+  const search::Options options = search::parse_options(argc, argv);
+  if (options.mini)
+    search::run<BlokusDuoMini>(options);
+  else
+    search::run<BlokusDuoStandard>(options);
+  return 0;
+}
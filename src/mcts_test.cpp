@@ -0,0 +1,116 @@
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "blokusduo_mcts.h"
+
+namespace blokusduo::search {
+namespace {
+
+template <class Game>
+BoardImpl<Game> random_position(int turns, uint64_t seed) {
+  std::mt19937 random(seed);
+  BoardImpl<Game> board;
+  while (board.turn() < turns && !board.is_game_over()) {
+    const std::vector<Move> moves = board.valid_moves();
+    board.play_move(moves[random() % moves.size()]);
+  }
+  return board;
+}
+
+template <typename T>
+class MctsTest : public testing::Test {};
+
+using Games = ::testing::Types<BlokusDuoMini, BlokusDuoStandard>;
+TYPED_TEST_SUITE(MctsTest, Games);
+
+TYPED_TEST(MctsTest, ReturnsLegalMove) {
+  for (auto leaf : {MctsOptions::EVALUATION, MctsOptions::ROLLOUT}) {
+    for (int turn : {0, 1, 6}) {
+      const BoardImpl<TypeParam> board = random_position<TypeParam>(turn, 1);
+      MctsOptions options;
+      options.leaf = leaf;
+      Mcts<TypeParam> mcts(board, options);
+      visited_nodes = 0;
+      const SearchResult result = mcts.search(200, 0);
+      EXPECT_TRUE(board.is_valid_move(result.first));
+      EXPECT_LE(-1000, result.second);
+      EXPECT_GE(1000, result.second);
+      EXPECT_EQ(200, visited_nodes);
+    }
+  }
+}
+
+TYPED_TEST(MctsTest, ThreadsShareTheTree) {
+  MctsOptions options;
+  options.threads = 4;
+  Mcts<TypeParam> mcts(random_position<TypeParam>(4, 2), options);
+  mcts.search(2000, 0);
+  EXPECT_EQ(2000, mcts.root_visits());
+
+  // Playouts that find the root unexpanded stop there; every other playout
+  // visits exactly one root move.
+  long child_visits = 0;
+  for (const auto& [move, visits] : mcts.root_visit_counts())
+    child_visits += visits;
+  EXPECT_LE(2000 - options.threads, child_visits);
+  EXPECT_GT(2000, child_visits);
+}
+
+TYPED_TEST(MctsTest, AdvanceKeepsSubtree) {
+  const BoardImpl<TypeParam> board = random_position<TypeParam>(2, 3);
+  Mcts<TypeParam> mcts(board);
+  const Move move = mcts.search(1000, 0).first;
+  int visits = 0;
+  for (const auto& [m, v] : mcts.root_visit_counts()) {
+    if (m == move) visits = v;
+  }
+  ASSERT_LT(1, visits);
+
+  mcts.advance(move);
+  EXPECT_EQ(board.child(move).key(), mcts.root().key());
+  EXPECT_EQ(visits, mcts.root_visits());
+  mcts.search(100, 0);
+  EXPECT_EQ(visits + 100, mcts.root_visits());
+
+  // A move that was never visited starts a new tree.
+  for (const auto& [m, v] : mcts.root_visit_counts()) {
+    if (v == 0) {
+      mcts.advance(m);
+      EXPECT_EQ(0, mcts.root_visits());
+      break;
+    }
+  }
+}
+
+TYPED_TEST(MctsTest, BuiltinEvaluatorMatchesNegaEval) {
+  const BoardImpl<TypeParam> board = random_position<TypeParam>(3, 4);
+  BuiltinEvaluator<TypeParam> evaluator;
+  Mcts<TypeParam> expected(board);
+  Mcts<TypeParam> actual(board, {}, &evaluator);
+  EXPECT_EQ(expected.search(500, 0), actual.search(500, 0));
+  EXPECT_EQ(expected.root_visit_counts(), actual.root_visit_counts());
+}
+
+TEST(Mcts, RolloutsFindWinningEndgameMoves) {
+  using Board = BoardImpl<BlokusDuoMini>;
+  int tested = 0;
+  for (uint64_t seed = 0; tested < 5; seed++) {
+    const Board board = random_position<BlokusDuoMini>(10, seed);
+    if (board.is_game_over() || perfect(board).second <= 0) continue;
+    tested++;
+
+    MctsOptions options;
+    options.leaf = MctsOptions::ROLLOUT;
+    Mcts<BlokusDuoMini> mcts(board, options);
+    const Move move = mcts.search(20000, 0).first;
+    const Board child = board.child(move);
+    const int value =
+        child.is_game_over() ? -child.relative_score() : -perfect(child).second;
+    EXPECT_GT(value, 0) << board.to_string() << move.code();
+  }
+}
+
+}  // namespace
+}  // namespace blokusduo::search
@@ -0,0 +1,60 @@
+#ifndef MOVE_LIST_H_
+#define MOVE_LIST_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "blokusduo.h"
+
+namespace blokusduo {
+
+// The valid moves of one player, kept up to date as moves are played instead
+// of being generated again for each board. A move of the player adds the
+// placements at the anchors it creates and drops the ones it blocks, which
+// play_move() does. A move of the opponent can only take placements away, and
+// visit_moves() skips those as it goes, so one list serves every board
+// reached from its own by opponent moves. This works with copy-based search,
+// which keeps a copy per ply, and with make/unmake, which saves the list
+// before the player's own moves. board.cpp defines it next to the move
+// generator whose helpers it shares.
+template <class Game>
+class MoveList {
+ public:
+  using Board = BoardImpl<Game>;
+
+  // A list with no moves.
+  MoveList() = default;
+
+  // Generates the moves of `player` on `board`.
+  MoveList(const Board& board, int player);
+
+  int player() const { return player_; }
+
+  // Updates the list for `move`, played by the list's player to give `board`.
+  void play_move(const Board& board, Move move);
+
+  // Visits the moves of the list that are valid on `board`, which must be the
+  // list's board or one reached from it by opponent moves, with the list's
+  // player to move. From the third turn on, these are the same moves, in the
+  // same order, as BoardImpl::visit_moves() visits.
+  bool visit_moves(const Board& board,
+                   typename Board::MoveVisitor* visitor) const;
+
+ private:
+  struct Entry {
+    // The oriented piece (an index of the generated piece table) << 24 | the
+    // first anchor it covers << 8 | the top row of the placement. Entries are
+    // sorted by it.
+    uint32_t key;
+    uint16_t move;
+    // The cells covered in the top row and the four below it.
+    uint16_t rows[5];
+  };
+  std::vector<Entry> entries_;
+  int player_ = 0;
+};
+
+}  // namespace blokusduo
+
+#endif  // MOVE_LIST_H_
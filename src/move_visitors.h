@@ -0,0 +1,43 @@
+#ifndef MOVE_VISITORS_H_
+#define MOVE_VISITORS_H_
+
+#include <stdint.h>
+
+#include <random>
+#include <vector>
+
+#include "blokusduo.h"
+
+namespace blokusduo {
+
+// Collects the visited moves in order.
+template <class Game>
+class MoveCollector : public BoardImpl<Game>::MoveVisitor {
+ public:
+  MoveCollector() { moves.reserve(Game::CHILD_RESERVE); }
+  bool visit_move(Move m) override {
+    moves.push_back(m);
+    return true;
+  }
+  std::vector<Move> moves;
+};
+
+// Chooses a uniformly random legal move by reservoir sampling, without
+// collecting the moves: the n-th move replaces the choice with probability
+// 1/n. `count` is the number of moves visited.
+template <class Game>
+class RandomMoveVisitor : public BoardImpl<Game>::MoveVisitor {
+ public:
+  explicit RandomMoveVisitor(std::mt19937_64* random) : random(random) {}
+  bool visit_move(Move m) override {
+    if ((*random)() % ++count == 0) move = m;
+    return true;
+  }
+  std::mt19937_64* random;
+  uint64_t count = 0;
+  Move move = Move::pass();
+};
+
+}  // namespace blokusduo
+
+#endif  // MOVE_VISITORS_H_
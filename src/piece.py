@@ -1,5 +1,7 @@
 #!/usr/bin/env python3
 
+import sys
+
 class Piece:
     def __init__(self, orientation, name, coords):
         self.orientation = orientation
@@ -97,29 +99,79 @@ def to_c(obj):
     else:
         return str(obj)
 
-def generate_cpp():
+def ordered_pieces():
+    """Returns (piece, orientation_id) for every oriented piece in
+    BlokusDuoStandard::piece_set order, which lists the blocks from last to
+    first."""
+    return [(piece, id << 3 | piece.orientation)
+            for id, blk in reversed(list(enumerate(BLOCK_SET)))
+            for piece in blk]
+
+def action_offsets(pieces, num_blocks, xsize, ysize):
+    """Returns the first action ID of each oriented piece in `pieces` order,
+    matching BoardImpl::all_possible_moves(), and the number of placements."""
+    offsets = [0] * (num_blocks * 8)
+    total = 0
+    for (piece, orientation_id) in pieces:
+        offsets[orientation_id] = total
+        total += ((xsize - (piece.max_x - piece.min_x)) *
+                  (ysize - (piece.max_y - piece.min_y)))
+    return offsets, total
+
+def print_action_offsets(game, pieces, num_blocks, xsize, ysize):
+    offsets, total = action_offsets(pieces, num_blocks, xsize, ysize)
+    print(f"static_assert({game}::NUM_ACTIONS == {total + 1});")
+    print(f"const uint16_t {game}::action_offsets[] = {{")
+    for start in range(0, len(offsets), 8):
+        print(f"  {', '.join(map(str, offsets[start:start + 8]))},")
+    print("};")
+
+def generate_header():
+    pieces = ordered_pieces()
+    print('#ifndef PIECE_DATA_H_')
+    print('#define PIECE_DATA_H_')
+    print()
     print('#include "piece.h"')
     print()
     print('namespace blokusduo {')
     print()
-    print('namespace {')
+    print('// Every oriented piece, in BlokusDuoStandard::piece_set order. The Mini')
+    print('// piece set is the last BlokusDuoMini::NUM_ORIENTED_PIECES of them.')
+    print('inline constexpr Piece oriented_pieces[] = {')
+    for piece, orientation_id in pieces:
+        fs = ["0x%02x" % orientation_id, piece.size, to_c(piece.coords),
+              to_c([len(corner) for corner in piece.directed_corners]),
+              to_c(piece.directed_corners),
+              piece.min_x, piece.min_y, piece.max_x, piece.max_y]
+        print(f"  {{{', '.join(map(str, fs))}}},  // {piece.name}")
+    print('};')
+    print()
+    print('// The rows of each piece in oriented_pieces, as in piece_row_masks.')
+    print('inline constexpr uint8_t oriented_piece_rows[][5] = {')
+    for piece, _ in pieces:
+        print(f"  {to_c(piece.row_masks + [0] * (5 - len(piece.row_masks)))},")
+    print('};')
+    print()
+    print('}  // namespace blokusduo')
     print()
-    pieces = []
+    print('#endif  // PIECE_DATA_H_')
+
+def generate_cpp():
+    pieces = ordered_pieces()
+    mini_pieces = [item for item in pieces if item[0].size <= 4]
+    assert pieces[len(pieces) - len(mini_pieces):] == mini_pieces
+    num_mini_blocks = sum(1 for blk in BLOCK_SET if blk.size <= 4)
+    index = {piece.name: i for i, (piece, _) in enumerate(pieces)}
+    def ref(piece):
+        return f"&oriented_pieces[{index[piece.name]}]"
+
     row_masks = [[0] * 5 for _ in range(len(BLOCK_SET) * 8)]
-    for id, blk in enumerate(BLOCK_SET):
-        pieces.insert(0, [])
-        for piece in blk:
-            fs = ["0x%02x" % (id << 3 | piece.orientation), piece.size, to_c(piece.coords),
-                  to_c([len(corner) for corner in piece.directed_corners]),
-                  to_c(piece.directed_corners),
-                  piece.min_x, piece.min_y, piece.max_x, piece.max_y]
-            print(f"const Piece {piece.name} = {{{', '.join(map(str, fs))}}};")
-            pieces[0].append(('&' + piece.name, piece.size))
-            orientation_id = id << 3 | piece.orientation
-            row_masks[orientation_id][:len(piece.row_masks)] = piece.row_masks
-    pieces = [item for sublist in pieces for item in sublist]
+    for piece, orientation_id in pieces:
+        row_masks[orientation_id][:len(piece.row_masks)] = piece.row_masks
+
+    print('#include "piece_data.h"')
     print()
-    print('}  // namespace')
+    print('namespace blokusduo {')
     print()
     print("const uint8_t piece_row_masks[][5] = {")
     for start in range(0, len(row_masks), 8):
@@ -128,19 +180,23 @@ def generate_cpp():
     print("};")
     print()
     print("const std::array<const Piece*, BlokusDuoMini::NUM_ORIENTED_PIECES> BlokusDuoMini::piece_set = {")
-    print(f"  {', '.join([e for (e, n) in pieces if n <= 4])}")
+    print(f"  {', '.join([ref(piece) for (piece, _) in mini_pieces])}")
     print("};")
     print()
     print("const std::array<const Piece*, BlokusDuoStandard::NUM_ORIENTED_PIECES> BlokusDuoStandard::piece_set = {")
-    print(f"  {', '.join([e for (e, _) in pieces])}")
+    print(f"  {', '.join([ref(piece) for (piece, _) in pieces])}")
     print("};")
     print()
+    print_action_offsets("BlokusDuoMini", mini_pieces, num_mini_blocks, 8, 8)
+    print()
+    print_action_offsets("BlokusDuoStandard", pieces, len(BLOCK_SET), 14, 14)
+    print()
     print("const Block block_set[] = {")
     for blk in BLOCK_SET:
         print("  {")
         print(f"    '{blk.name}', {blk.size},")
-        print(f"    {{ {', '.join(['&'+p.name for p in blk])}, nullptr }},")
-        rot = ', '.join([f"{{{dx},{dy},&{piece.name}}}" for dx, dy, piece in [blk.rotate(0,0,dir) for dir in range(8)]])
+        print(f"    {{ {', '.join([ref(p) for p in blk])}, nullptr }},")
+        rot = ', '.join([f"{{{dx},{dy},{ref(piece)}}}" for dx, dy, piece in [blk.rotate(0,0,dir) for dir in range(8)]])
         print(f"    {{ {rot} }}")
         print("  },")
     print("};")
@@ -148,4 +204,7 @@ def generate_cpp():
     print('}  // namespace blokusduo')
 
 if __name__ == "__main__":
-    generate_cpp()
+    if sys.argv[1:] == ["--header"]:
+        generate_header()
+    else:
+        generate_cpp()
@@ -0,0 +1,283 @@
+#include <assert.h>
+#include <string.h>
+
+#include <algorithm>
+#include <bit>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "blokusduo_record.h"
+
+namespace blokusduo::record {
+namespace {
+
+static_assert(std::endian::native == std::endian::little,
+              "Record files are read and written in native byte order");
+
+constexpr uint16_t VERSION = 1;
+constexpr uint8_t HAS_VALUES = 1;
+
+struct FileHeader {
+  char magic[4];
+  uint16_t version;
+  uint8_t reserved[10];
+};
+static_assert(sizeof(FileHeader) == 16);
+
+struct ChunkHeader {
+  char magic[4];
+  uint32_t num_games;
+  uint32_t size;
+  uint32_t index_offset;
+};
+static_assert(sizeof(ChunkHeader) == 16);
+
+struct GameHeader {
+  uint64_t seed;
+  float temperature;
+  uint16_t num_plies;
+  uint8_t variant;
+  uint8_t flags;
+  uint8_t score[2];
+  uint8_t reserved[6];
+};
+static_assert(sizeof(GameHeader) == 24);
+
+constexpr size_t padded(size_t size) { return (size + 7) & ~size_t{7}; }
+
+size_t game_size(const GameHeader& header) {
+  const size_t moves = padded(header.num_plies * sizeof(uint16_t));
+  return sizeof(GameHeader) + (header.flags & HAS_VALUES ? 2 * moves : moves);
+}
+
+// Whether `header`, read at `offset` in a file of `file_size` bytes, is that
+// of a complete chunk with its index inside it. A truncated chunk left by an
+// interrupted writer is not.
+bool is_complete_chunk(const ChunkHeader& header, size_t offset,
+                       size_t file_size) {
+  return memcmp(header.magic, "BDCK", 4) == 0 &&
+         header.size >= sizeof(ChunkHeader) &&
+         header.index_offset >= sizeof(ChunkHeader) &&
+         header.size <= file_size - offset &&
+         header.index_offset + uint64_t{header.num_games} * sizeof(uint32_t) <=
+             header.size;
+}
+
+void append(std::vector<uint8_t>* out, const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  out->insert(out->end(), bytes, bytes + size);
+  out->resize(padded(out->size()));
+}
+
+}  // namespace
+
+Writer::Writer(const std::string& path, int games_per_chunk)
+    : games_per_chunk_(games_per_chunk) {
+  fp_ = fopen(path.c_str(), "a+b");
+  if (!fp_) return;
+  if (fseek(fp_, 0, SEEK_END) != 0) {
+    failed_ = true;
+    return;
+  }
+  const long size = ftell(fp_);
+  if (size < 0) {
+    failed_ = true;
+    return;
+  }
+
+  // Leave alone a file that is not a record of this version, as Reader
+  // rejects it.
+  size_t end = 0;
+  if (size > 0) {
+    FileHeader file_header;
+    if (static_cast<size_t>(size) < sizeof(file_header) ||
+        fseek(fp_, 0, SEEK_SET) != 0 ||
+        fread(&file_header, sizeof(file_header), 1, fp_) != 1 ||
+        memcmp(file_header.magic, "BDGR", 4) != 0 ||
+        file_header.version != VERSION) {
+      failed_ = true;
+      return;
+    }
+
+    // Drop a truncated chunk left by an interrupted writer: readers stop at
+    // it, so the chunks appended after it could never be read.
+    end = sizeof(file_header);
+    ChunkHeader header;
+    while (fseek(fp_, end, SEEK_SET) == 0 &&
+           fread(&header, sizeof(header), 1, fp_) == 1 &&
+           is_complete_chunk(header, end, size))
+      end += header.size;
+  }
+  if (end < static_cast<size_t>(size)) {
+#if defined(_WIN32)
+    failed_ = _chsize_s(_fileno(fp_), end) != 0;
+#else
+    failed_ = ftruncate(fileno(fp_), end) != 0;
+#endif
+    if (failed_) return;
+  }
+  if (fseek(fp_, 0, SEEK_END) != 0) {
+    failed_ = true;
+    return;
+  }
+  if (end == 0) {
+    FileHeader header = {{'B', 'D', 'G', 'R'}, VERSION, {}};
+    failed_ = fwrite(&header, sizeof(header), 1, fp_) != 1;
+  }
+}
+
+Writer::~Writer() {
+  if (!fp_) return;
+  flush();
+  fclose(fp_);
+}
+
+void Writer::write(const GameRecord& game) {
+  assert(game.values.empty() || game.values.size() == game.moves.size());
+  if (chunk_.empty()) chunk_.resize(sizeof(ChunkHeader));
+  offsets_.push_back(chunk_.size());
+
+  GameHeader header = {};
+  header.seed = game.seed;
+  header.temperature = game.temperature;
+  header.num_plies = game.moves.size();
+  header.variant = static_cast<uint8_t>(game.variant);
+  header.flags = game.values.empty() ? 0 : HAS_VALUES;
+  header.score[0] = game.score[0];
+  header.score[1] = game.score[1];
+  append(&chunk_, &header, sizeof(header));
+
+  std::vector<uint16_t> moves(game.moves.size());
+  for (size_t ply = 0; ply < moves.size(); ply++)
+    moves[ply] = game.moves[ply].raw();
+  append(&chunk_, moves.data(), moves.size() * sizeof(uint16_t));
+  append(&chunk_, game.values.data(), game.values.size() * sizeof(int16_t));
+
+  if (offsets_.size() >= static_cast<size_t>(games_per_chunk_)) flush();
+}
+
+void Writer::flush() {
+  if (offsets_.empty() || !ok()) return;
+  ChunkHeader header = {{'B', 'D', 'C', 'K'},
+                        static_cast<uint32_t>(offsets_.size()),
+                        0,
+                        static_cast<uint32_t>(chunk_.size())};
+  append(&chunk_, offsets_.data(), offsets_.size() * sizeof(uint32_t));
+  header.size = chunk_.size();
+  memcpy(chunk_.data(), &header, sizeof(header));
+  // A chunk is written with one call so that readers never see a partial
+  // index, and flushed so that it survives a crash of the writer.
+  failed_ = fwrite(chunk_.data(), chunk_.size(), 1, fp_) != 1 ||
+            fflush(fp_) != 0;
+  chunk_.clear();
+  offsets_.clear();
+}
+
+Reader::Reader(const std::string& path) {
+#if defined(_WIN32)
+  FILE* fp = fopen(path.c_str(), "rb");
+  if (!fp) return;
+  fseek(fp, 0, SEEK_END);
+  size_ = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  uint8_t* buffer = new uint8_t[size_];
+  if (fread(buffer, 1, size_, fp) != size_) size_ = 0;
+  fclose(fp);
+  data_ = buffer;
+#else
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size >= 0) {
+    size_ = st.st_size;
+    void* p = size_ > 0 ? mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0)
+                        : MAP_FAILED;
+    if (p != MAP_FAILED) {
+      data_ = static_cast<const uint8_t*>(p);
+      mapped_ = true;
+    }
+  }
+  close(fd);
+  if (!data_) return;
+#endif
+
+  FileHeader file_header;
+  if (size_ < sizeof(file_header)) {
+    release();
+    return;
+  }
+  memcpy(&file_header, data_, sizeof(file_header));
+  if (memcmp(file_header.magic, "BDGR", 4) != 0 ||
+      file_header.version != VERSION) {
+    release();
+    return;
+  }
+
+  for (size_t offset = sizeof(FileHeader);
+       offset + sizeof(ChunkHeader) <= size_;) {
+    ChunkHeader header;
+    memcpy(&header, data_ + offset, sizeof(header));
+    // Stop at a truncated chunk left by an interrupted writer.
+    if (!is_complete_chunk(header, offset, size_)) break;
+    const uint8_t* chunk = data_ + offset;
+    for (uint32_t i = 0; i < header.num_games; i++) {
+      uint32_t game_offset;
+      memcpy(&game_offset, chunk + header.index_offset + i * sizeof(uint32_t),
+             sizeof(game_offset));
+      const uint8_t* game = chunk + game_offset;
+      GameHeader game_header;
+      if (game_offset + sizeof(game_header) > header.index_offset) break;
+      memcpy(&game_header, game, sizeof(game_header));
+      if (game_offset + game_size(game_header) > header.index_offset) break;
+      games_.push_back(game);
+      first_positions_.push_back(first_positions_.back() +
+                                 game_header.num_plies);
+    }
+    offset += header.size;
+  }
+}
+
+Reader::~Reader() { release(); }
+
+void Reader::release() {
+  if (!data_) return;
+#if defined(_WIN32)
+  delete[] data_;
+#else
+  if (mapped_) munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+  data_ = nullptr;
+}
+
+GameView Reader::game(size_t index) const {
+  const uint8_t* game = games_[index];
+  const GameHeader* header = reinterpret_cast<const GameHeader*>(game);
+  const uint16_t* moves =
+      reinterpret_cast<const uint16_t*>(game + sizeof(GameHeader));
+  const int16_t* values = reinterpret_cast<const int16_t*>(
+      game + sizeof(GameHeader) +
+      padded(header->num_plies * sizeof(uint16_t)));
+  return GameView{
+      static_cast<Variant>(header->variant),
+      header->seed,
+      header->temperature,
+      {header->score[0], header->score[1]},
+      {moves, header->num_plies},
+      {values, header->flags & HAS_VALUES ? header->num_plies : size_t{0}}};
+}
+
+std::pair<size_t, size_t> Reader::locate_position(uint64_t position) const {
+  const auto next = std::upper_bound(first_positions_.begin(),
+                                     first_positions_.end(), position);
+  const size_t game = next - first_positions_.begin() - 1;
+  return {game, position - first_positions_[game]};
+}
+
+}  // namespace blokusduo::record
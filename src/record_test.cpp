@@ -0,0 +1,187 @@
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "blokusduo_record.h"
+
+namespace blokusduo::record {
+namespace {
+
+template <class Game>
+GameRecord random_game(uint64_t seed, bool with_values) {
+  std::mt19937 random(seed);
+  GameRecord record;
+  record.variant = variant_of<Game>;
+  record.seed = seed;
+  record.temperature = 0.5;
+  BoardImpl<Game> board;
+  while (!board.is_game_over()) {
+    const std::vector<Move> moves = board.valid_moves();
+    record.moves.push_back(moves[random() % moves.size()]);
+    if (with_values) record.values.push_back(random() % 201 - 100);
+    board.play_move(record.moves.back());
+  }
+  record.score[0] = board.score(0);
+  record.score[1] = board.score(1);
+  return record;
+}
+
+std::string temp_path(const char* name) {
+  const std::string path = testing::TempDir() + name;
+  std::filesystem::remove(path);
+  return path;
+}
+
+void expect_same_game(const GameRecord& expected, const GameView& actual) {
+  EXPECT_EQ(expected.variant, actual.variant);
+  EXPECT_EQ(expected.seed, actual.seed);
+  EXPECT_EQ(expected.temperature, actual.temperature);
+  EXPECT_EQ(expected.score[0], actual.score[0]);
+  EXPECT_EQ(expected.score[1], actual.score[1]);
+  ASSERT_EQ(expected.moves.size(), actual.moves.size());
+  for (size_t ply = 0; ply < expected.moves.size(); ply++)
+    EXPECT_EQ(expected.moves[ply], actual.move(ply));
+  EXPECT_EQ(expected.values,
+            std::vector<int16_t>(actual.values.begin(), actual.values.end()));
+}
+
+TEST(Record, RoundTrip) {
+  const std::string path = temp_path("round_trip.bdgr");
+  std::vector<GameRecord> games;
+  for (int i = 0; i < 10; i++) {
+    games.push_back(i % 2 ? random_game<BlokusDuoMini>(i, i % 3 == 0)
+                          : random_game<BlokusDuoStandard>(i, i % 3 == 0));
+  }
+  {
+    Writer writer(path, 4);
+    ASSERT_TRUE(writer.ok());
+    for (const GameRecord& game : games) writer.write(game);
+  }
+
+  Reader reader(path);
+  ASSERT_TRUE(reader.ok());
+  ASSERT_EQ(games.size(), reader.size());
+  uint64_t positions = 0;
+  for (size_t i = 0; i < games.size(); i++) {
+    SCOPED_TRACE(testing::Message() << "game " << i);
+    expect_same_game(games[i], reader.game(i));
+    EXPECT_EQ(positions, reader.first_position(i));
+    positions += games[i].moves.size();
+  }
+  EXPECT_EQ(positions, reader.num_positions());
+
+  for (uint64_t position = 0; position < positions; position += 7) {
+    const auto [game, ply] = reader.locate_position(position);
+    EXPECT_EQ(position, reader.first_position(game) + ply);
+    EXPECT_LT(ply, games[game].moves.size());
+  }
+}
+
+TEST(Record, ReplaysPositions) {
+  const std::string path = temp_path("replay.bdgr");
+  const GameRecord expected = random_game<BlokusDuoStandard>(1, false);
+  { Writer(path).write(expected); }
+
+  Reader reader(path);
+  ASSERT_EQ(1, reader.size());
+  BoardImpl<BlokusDuoStandard> last;
+  size_t count = 0;
+  for_each_position<BlokusDuoStandard>(
+      reader.game(0),
+      [&](const BoardImpl<BlokusDuoStandard>& board, Move move, size_t ply) {
+        EXPECT_EQ(count++, ply);
+        EXPECT_TRUE(board.is_valid_move(move));
+        last = board;
+        last.play_move(move);
+      });
+  EXPECT_EQ(expected.moves.size(), count);
+  EXPECT_TRUE(last.is_game_over());
+  EXPECT_EQ(expected.score[0], last.score(0));
+  EXPECT_EQ(expected.score[1], last.score(1));
+}
+
+TEST(Record, AppendsToExistingFile) {
+  const std::string path = temp_path("append.bdgr");
+  const GameRecord first = random_game<BlokusDuoMini>(1, true);
+  const GameRecord second = random_game<BlokusDuoMini>(2, true);
+  { Writer(path).write(first); }
+  { Writer(path).write(second); }
+
+  Reader reader(path);
+  ASSERT_EQ(2, reader.size());
+  expect_same_game(first, reader.game(0));
+  expect_same_game(second, reader.game(1));
+}
+
+TEST(Record, IgnoresTruncatedChunk) {
+  const std::string path = temp_path("truncated.bdgr");
+  const GameRecord first = random_game<BlokusDuoMini>(1, true);
+  {
+    Writer writer(path, 1);
+    writer.write(first);
+    writer.write(random_game<BlokusDuoMini>(2, true));
+  }
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+  {
+    Reader reader(path);
+    ASSERT_TRUE(reader.ok());
+    ASSERT_EQ(1, reader.size());
+    expect_same_game(first, reader.game(0));
+  }
+
+  // A writer reopening the file drops the truncated chunk before appending.
+  const GameRecord third = random_game<BlokusDuoMini>(3, true);
+  {
+    Writer writer(path);
+    ASSERT_TRUE(writer.ok());
+    writer.write(third);
+  }
+  Reader reader(path);
+  ASSERT_TRUE(reader.ok());
+  ASSERT_EQ(2, reader.size());
+  expect_same_game(first, reader.game(0));
+  expect_same_game(third, reader.game(1));
+}
+
+TEST(Record, RejectsEmptyChunk) {
+  const std::string path = temp_path("empty_chunk.bdgr");
+  {
+    Writer writer(path);
+    writer.write(random_game<BlokusDuoMini>(1, false));
+  }
+  // A chunk header claiming a size of zero must not stall the reader.
+  FILE* fp = fopen(path.c_str(), "ab");
+  const char header[16] = {'B', 'D', 'C', 'K'};
+  fwrite(header, sizeof(header), 1, fp);
+  fclose(fp);
+
+  Reader reader(path);
+  ASSERT_TRUE(reader.ok());
+  EXPECT_EQ(1, reader.size());
+}
+
+TEST(Record, RejectsOtherFiles) {
+  EXPECT_FALSE(Reader(temp_path("missing.bdgr")).ok());
+
+  const std::string path = temp_path("not_a_record.txt");
+  FILE* fp = fopen(path.c_str(), "w");
+  const std::string text = "0123456789abcdef 1.000 0 0 u:0\n";
+  fputs(text.c_str(), fp);
+  fclose(fp);
+  EXPECT_FALSE(Reader(path).ok());
+
+  // A writer does not repair or append to it either.
+  EXPECT_FALSE(Writer(path).ok());
+  fp = fopen(path.c_str(), "rb");
+  std::string contents(text.size() + 1, '\0');
+  contents.resize(fread(contents.data(), 1, contents.size(), fp));
+  fclose(fp);
+  EXPECT_EQ(contents, text);
+}
+
+}  // namespace
+}  // namespace blokusduo::record
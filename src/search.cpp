@@ -1,16 +1,24 @@
 #include <assert.h>
 #include <limits.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <bitset>
+#include <chrono>
 #include <cmath>
 #include <memory>
 #include <random>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
 #include "blokusduo.h"
+#include "blokusduo_evaluator.h"
+#include "move_list.h"
+#include "move_visitors.h"
 #include "piece.h"
 
 #define USE_PROBCUT
@@ -22,43 +30,137 @@
 
 namespace blokusduo::search {
 
-int visited_nodes;
+thread_local int visited_nodes;
 
 namespace {
 
+// Bounds on the value of a position for the player to move, and the move
+// that raised the lower bound, if any.
+struct HashEntry {
+  int lower = -INT_MAX;
+  int upper = INT_MAX;
+  Move best_move;
+};
+
+template <class Game>
+using Hash = std::unordered_map<typename BoardImpl<Game>::Key, HashEntry,
+                                typename BoardImpl<Game>::Key::Hash>;
+
+// Killer moves and a history table, kept across the iterations of one
+// search. Near the leaves, they order the moves in place of a full
+// evaluation of the children.
+template <class Game>
+class MoveOrdering {
+ public:
+  // Turns of a game, including both passes.
+  static constexpr int MAX_TURN = Game::NUM_PIECES * 2 + 2;
+
+  bool is_killer(const BoardImpl<Game>& node, Move move) const {
+    if (node.turn() >= MAX_TURN) return false;
+    const auto& killers = killers_[node.turn()];
+    return move == killers[0] || move == killers[1];
+  }
+
+  int history(const BoardImpl<Game>& node, Move move) const {
+    return move.is_pass() ? 0 : history_[index(node, move)];
+  }
+
+  // Returns a key that orders the moves of `node` from the most promising:
+  // larger pieces first, then killer moves, then by history.
+  int order(const BoardImpl<Game>& node, Move move) const {
+    const int size = move.is_pass() ? 0 : block_set[move.piece_id()].size;
+    return -(size << 27) - (is_killer(node, move) ? 1 << 26 : 0) -
+           history(node, move);
+  }
+
+  // Records that `move` caused a beta cutoff in a search of `depth` plies.
+  void add_cutoff(const BoardImpl<Game>& node, Move move, int depth) {
+    if (move.is_pass()) return;
+    if (node.turn() < MAX_TURN) {
+      auto& killers = killers_[node.turn()];
+      if (killers[0] != move) {
+        killers[1] = killers[0];
+        killers[0] = move;
+      }
+    }
+    int& entry = history_[index(node, move)];
+    entry += depth * depth;
+    // Keep history below the killer bonus in order().
+    if (entry > HISTORY_MAX) {
+      for (int& h : history_) h /= 2;
+    }
+  }
+
+ private:
+  static constexpr int HISTORY_MAX = 1 << 25;
+  // The 16-bit encoding of a move packs its piece, orientation and square.
+  static constexpr int MOVES = Game::NUM_PIECES << 11;
+
+  static int index(const BoardImpl<Game>& node, Move move) {
+    return node.player() * MOVES + move.raw();
+  }
+
+  std::array<std::array<Move, 2>, MAX_TURN> killers_;
+  std::vector<int> history_ = std::vector<int>(2 * MOVES);
+};
+
+// The key of a position in the transposition tables. A search from a root
+// that is its own transpose meets every position along with its transpose,
+// and gives both the smaller of their keys. `transposed` tells whether that
+// is the transpose's, whose entry holds transposed moves.
 template <class Game>
-using Hash =
-    std::unordered_map<typename BoardImpl<Game>::Key, std::pair<int, int>,
-                       typename BoardImpl<Game>::Key::Hash>;
+struct TableKey {
+  // Converts a move between the position and its table entry.
+  Move convert(Move move) const {
+    if (!transposed || !move.is_valid()) return move;
+    return BoardImpl<Game>::rotate_move(move, BoardImpl<Game>::TRANSPOSE);
+  }
+
+  typename BoardImpl<Game>::Key key;
+  bool transposed = false;
+};
+
+template <class Game>
+TableKey<Game> table_key(const BoardImpl<Game>& node, bool symmetric) {
+  if (!symmetric) return {node.key()};
+  const typename BoardImpl<Game>::Key transposed = node.transposed_key();
+  if (memcmp(&transposed, &node.key(), sizeof(transposed)) < 0)
+    return {transposed, true};
+  return {node.key()};
+}
 
 template <class Game>
 struct Child {
-  Child(const BoardImpl<Game>& b, Move m, Hash<Game>* hash,
-        bool use_full_evaluation);
+  Child(const BoardImpl<Game>& b, Move m, Hash<Game>* hash, bool symmetric);
   BoardImpl<Game> board;
+  // Children are searched in increasing order of (rank, score): first those
+  // that the previous iteration bounded, by their value, then the others by
+  // evaluation.
+  int rank;
   int score;
   Move move;
+  // The key of `board` in the transposition tables.
+  typename BoardImpl<Game>::Key key;
 };
 
 template <class Game>
 Child<Game>::Child(const BoardImpl<Game>& b, Move m, Hash<Game>* hash,
-                   bool use_full_evaluation)
-    : board(b.child(m)), move(m) {
-  // Use piece size as a cheap ordering heuristic near the leaves.
-  const auto evaluate_for_ordering = [&] {
-    if (use_full_evaluation) return board.nega_eval();
-    return move.is_pass() ? 0 : -block_set[move.piece_id()].size;
-  };
-  auto i = hash->find(board.key());
+                   bool symmetric)
+    : board(b.child(m)),
+      rank(0),
+      move(m),
+      key(table_key(board, symmetric).key) {
+  auto i = hash->find(key);
   if (i != hash->end()) {
-    int a = i->second.first;
-    int b = i->second.second;
-    if (a > -INT_MAX && b < INT_MAX)
-      score = (a + b) / 2 - 1000;
-    else
-      score = evaluate_for_ordering();
-  } else
-    score = evaluate_for_ordering();
+    int a = i->second.lower;
+    int b = i->second.upper;
+    if (a > -INT_MAX && b < INT_MAX) {
+      score = (a + b) / 2;
+      return;
+    }
+  }
+  rank = 1;
+  score = board.nega_eval();
 }
 
 template <class Game>
@@ -79,12 +181,14 @@ bool move_filter<BlokusDuoStandard>(
     return true;
 }
 
+// Collects the children of `board`, except `skip`, which has already been
+// searched. `symmetric` is SearchContext::symmetric.
 template <class Game>
 class ChildCollector : public BoardImpl<Game>::MoveVisitor {
  public:
-  ChildCollector(const BoardImpl<Game>& b, Hash<Game>* h,
-                 bool use_full_evaluation)
-      : board(b), hash(h), use_full_evaluation(use_full_evaluation) {
+  ChildCollector(const BoardImpl<Game>& b, Hash<Game>* h, bool symmetric,
+                 Move skip = Move())
+      : board(b), hash(h), symmetric(symmetric), skip(skip) {
     children.reserve(Game::CHILD_RESERVE);
   }
   bool filter(char piece, int orientation,
@@ -92,27 +196,155 @@ class ChildCollector : public BoardImpl<Game>::MoveVisitor {
     return move_filter(piece, orientation, board);
   }
   bool visit_move(Move m) override {
-    children.emplace_back(board, m, hash, use_full_evaluation);
+    if (m != skip) children.emplace_back(board, m, hash, symmetric);
     return true;
   }
   const BoardImpl<Game>& board;
   Hash<Game>* hash;
-  bool use_full_evaluation;
+  bool symmetric;
+  Move skip;
   std::vector<Child<Game>> children;
 };
 
+// Like ChildCollector, but only collects the moves with their order() keys,
+// leaving the child boards to be made when they are searched.
+template <class Game>
+class OrderedMoveCollector : public BoardImpl<Game>::MoveVisitor {
+ public:
+  OrderedMoveCollector(const BoardImpl<Game>& b,
+                       const MoveOrdering<Game>& ordering, Move skip)
+      : board(b), ordering(ordering), skip(skip) {
+    moves.reserve(Game::CHILD_RESERVE);
+  }
+  bool filter(char piece, int orientation,
+              const BoardImpl<Game>& board) noexcept override {
+    return move_filter(piece, orientation, board);
+  }
+  bool visit_move(Move m) override {
+    if (m != skip) moves.emplace_back(ordering.order(board, m), m);
+    return true;
+  }
+  const BoardImpl<Game>& board;
+  const MoveOrdering<Game>& ordering;
+  Move skip;
+  std::vector<std::pair<int, Move>> moves;
+};
+
+// Whether AlphaBetaVisitor reuses the opponent's influence across the
+// children. The Mini evaluation costs less than checking whether it can.
+template <class Game>
+constexpr bool REUSE_INFLUENCE = std::is_same_v<Game, BlokusDuoStandard>;
+
+// The number of children AlphaBetaVisitor evaluates at once after the first,
+// matching the SIMD lanes of BoardImpl::child_nega_evals().
+template <class Game>
+constexpr int LEAF_BATCH = std::is_same_v<Game, BlokusDuoMini> ? 4 : 1;
+
+// How far the influence term of a child, for the player who moved, falls
+// below and rises above that of its parent. Over the children of the depth-1
+// nodes in the searches of 20 Mini and 3 Standard random games, all but one
+// in 10^4 were within these. The extremes, -11..20 (Mini) and -18..51
+// (Standard), would let lazy evaluation fire less than half as often. Of the
+// children it decided, about one in 10^5 (Mini) and 10^4 (Standard) were
+// decided wrongly, as LazyEvalStats counts them.
+struct LazyEvalMargin {
+  int below;
+  int above;
+};
+
+template <class Game>
+constexpr LazyEvalMargin LAZY_EVAL_MARGIN =
+    std::is_same_v<Game, BlokusDuoMini> ? LazyEvalMargin{9, 17}
+                                        : LazyEvalMargin{14, 43};
+
+// Multi-cut: at a null-window node, the first `moves` children in move order
+// are searched `reduction` plies shallower, and if `cuts` of them fail high,
+// the node is assumed to fail high too.
+struct MultiCut {
+  int moves;
+  int cuts;
+  int reduction;
+};
+
+constexpr MultiCut MULTI_CUT = {6, 3, 2};
+
+// Searches the children of a node one ply above the horizon, evaluating them
+// without constructing their boards. Call flush() after visit_moves() to
+// evaluate the moves still pending.
 template <class Game>
 class AlphaBetaVisitor : public BoardImpl<Game>::MoveVisitor {
  public:
-  AlphaBetaVisitor(const BoardImpl<Game>& n, int a, int b)
-      : node(n), alpha(a), beta(b) {}
+  AlphaBetaVisitor(const BoardImpl<Game>& n, int a, int b,
+                   const SearchOptions<Game>& options)
+      : node(n),
+        alpha(a),
+        beta(b),
+        // A player's first piece gives them most of their influence, past
+        // any margin.
+        lazy_eval(options.lazy_eval && n.turn() >= 2),
+        lazy_eval_stats(options.lazy_eval_stats) {}
   bool filter(char piece, int orientation,
               const BoardImpl<Game>& board) noexcept override {
     return move_filter(piece, orientation, board);
   }
   bool visit_move(Move m) override {
-    visited_nodes++;
-    int v = -node.child(m).nega_eval();
+    // Like the caches below, the parent's influence waits for the second
+    // child.
+    if (lazy_eval && children > 0 && !m.is_pass()) {
+      if (!has_influence) {
+        influence = node.influence_nega_eval();
+        has_influence = true;
+      }
+      const int estimate = node.piece_nega_eval() +
+                           BoardImpl<Game>::piece_value(m) + influence;
+      if (estimate + LAZY_EVAL_MARGIN<Game>.above <= alpha) {
+        visited_nodes++;
+        if (lazy_eval_stats) count_shortcut(-node.child_nega_eval(m) > alpha);
+        return true;
+      }
+      if (estimate - LAZY_EVAL_MARGIN<Game>.below >= beta) {
+        visited_nodes++;
+        if (lazy_eval_stats) count_shortcut(-node.child_nega_eval(m) < beta);
+        alpha = beta;
+        return false;
+      }
+    }
+    if constexpr (REUSE_INFLUENCE<Game>) {
+      visited_nodes++;
+      // Most nodes cut off at the first child; do not pay for the cache
+      // before the second.
+      if (++children == 1) return update(-node.child_nega_eval(m));
+      if (children == 2) cache = node.opponent_influence();
+      return update(-node.child_nega_eval(m, cache));
+    } else {
+      pending[num_pending++] = m;
+      // The first child is evaluated alone for the same reason.
+      if (children > 0 && num_pending < LEAF_BATCH<Game>) return true;
+      return flush();
+    }
+  }
+
+  // Evaluates the pending moves. Returns false on a cutoff.
+  bool flush() {
+    if (num_pending == 0) return true;
+    int values[LEAF_BATCH<Game>];
+    node.child_nega_evals(std::span(pending.data(), num_pending), values);
+    visited_nodes += num_pending;
+    children += num_pending;
+    const int n = num_pending;
+    num_pending = 0;
+    for (int i = 0; i < n; i++) {
+      if (!update(-values[i])) return false;
+    }
+    return true;
+  }
+
+  const BoardImpl<Game>& node;
+  int alpha;
+  int beta;
+
+ private:
+  bool update(int v) {
     if (v > alpha) {
       alpha = v;
       if (alpha >= beta) return false;
@@ -120,34 +352,151 @@ class AlphaBetaVisitor : public BoardImpl<Game>::MoveVisitor {
     return true;
   }
 
+  void count_shortcut(bool wrong) {
+    lazy_eval_stats->shortcuts++;
+    if (wrong) lazy_eval_stats->wrong++;
+  }
+
+  const bool lazy_eval;
+  LazyEvalStats* const lazy_eval_stats;
+  bool has_influence = false;
+  int influence;
+  int children = 0;
+  typename BoardImpl<Game>::InfluenceCache cache;
+  std::array<Move, LEAF_BATCH<Game>> pending;
+  int num_pending = 0;
+};
+
+template <class Game>
+class LeafCollector : public BoardImpl<Game>::MoveVisitor {
+ public:
+  LeafCollector(const BoardImpl<Game>& n, std::vector<BoardImpl<Game>>* l)
+      : node(n), leaves(l) {}
+  bool filter(char piece, int orientation,
+              const BoardImpl<Game>& board) noexcept override {
+    return move_filter(piece, orientation, board);
+  }
+  bool visit_move(Move m) override {
+    visited_nodes++;
+    leaves->push_back(node.child(m));
+    return true;
+  }
+
   const BoardImpl<Game>& node;
-  int alpha;
-  int beta;
+  std::vector<BoardImpl<Game>>* leaves;
 };
 
+// The move lists of a search path. A node at ply i has those at i and i + 1:
+// the moves of its player to move, and of the other player. The first comes
+// from the grandparent, and only misses the parent's move, which
+// MoveList::visit_moves() allows. The second is the parent's first, after
+// the parent's move. Many nodes return from the hash table without
+// searching their children, so the update waits until they do.
+template <class Game>
+struct PathMoveList {
+  MoveList<Game> moves;
+  // The move to play on the previous list to give this one, if it is still
+  // to be played.
+  Move pending;
+};
+
+// State shared by the nodes of one negascout_gumbel() call.
+template <class Game>
+struct SearchContext {
+  explicit SearchContext(const SearchOptions<Game>& o) : options(o) {}
+
+  const SearchOptions<Game>& options;
+  MoveOrdering<Game> ordering;
+  // Buffers for batched leaf evaluation, reused across nodes.
+  std::vector<BoardImpl<Game>> leaves;
+  std::vector<int> leaf_values;
+  // The move lists of the nodes on the current path, one per ply plus one;
+  // see PathMoveList.
+  std::vector<PathMoveList<Game>> move_lists;
+  // Whether the root is its own transpose and SearchOptions::symmetry is
+  // set; see TableKey.
+  bool symmetric = false;
+};
+
+// Visits the moves of `node` from the first of its move lists, or generates
+// them if the search does not keep lists.
+template <class Game>
+bool visit_moves(const BoardImpl<Game>& node,
+                 const PathMoveList<Game>* lists,
+                 typename BoardImpl<Game>::MoveVisitor* visitor) {
+  return lists ? lists->moves.visit_moves(node, visitor)
+               : node.visit_moves(visitor);
+}
+
+// Returns the move lists to pass to the child made by `move` from the node
+// with `lists`, for a search of `depth` plies from it.
+template <class Game>
+PathMoveList<Game>* child_move_lists(PathMoveList<Game>* lists, Move move,
+                                     int depth) {
+  if (!lists) return nullptr;
+  // Below two plies, the child only visits its own moves.
+  if (depth >= 2) lists[2].pending = move;
+  return lists + 1;
+}
+
+// Brings the second move list of `node` up to date before its children are
+// searched. The first move list of its parent is at lists[-1].
+template <class Game>
+void update_move_lists(const BoardImpl<Game>& node,
+                       PathMoveList<Game>* lists) {
+  if (!lists || !lists[1].pending.is_valid()) return;
+  lists[1].moves = lists[-1].moves;
+  lists[1].moves.play_move(node, lists[1].pending);
+  lists[1].pending = Move();
+}
+
+// Same as the AlphaBetaVisitor loop, but evaluates all children with one
+// call to the evaluator, so it cannot stop at a cutoff.
+template <class Game>
+int evaluate_leaves(const BoardImpl<Game>& node, int alpha, int beta,
+                    const PathMoveList<Game>* lists,
+                    SearchContext<Game>* context) {
+  context->leaves.clear();
+  LeafCollector<Game> collector(node, &context->leaves);
+  visit_moves(node, lists, &collector);
+  context->leaf_values.resize(context->leaves.size());
+  context->options.evaluator->evaluate(context->leaves, context->leaf_values);
+  for (int value : context->leaf_values) {
+    if (-value > alpha) {
+      alpha = -value;
+      if (alpha >= beta) return beta;
+    }
+  }
+  return alpha;
+}
+
 template <class Game>
 int negascout_rec(const BoardImpl<Game>& node, int depth, int alpha, int beta,
                   Move* best_move, Hash<Game>* hash, Hash<Game>* prev_hash,
-                  int hash_depth) {
+                  int hash_depth, PathMoveList<Game>* lists,
+                  SearchContext<Game>* context) {
   assert(alpha <= beta);
 
   ++visited_nodes;
 
   if (depth <= 1) {
-    AlphaBetaVisitor<Game> visitor(node, alpha, beta);
-    if (node.visit_moves(&visitor))
+    if (context->options.evaluator)
+      return evaluate_leaves(node, alpha, beta, lists, context);
+    AlphaBetaVisitor<Game> visitor(node, alpha, beta, context->options);
+    if (visit_moves(node, lists, &visitor) && visitor.flush())
       return visitor.alpha;
     else
       return visitor.beta;
   }
 
-  std::pair<int, int>* hash_entry = nullptr;
+  const TableKey<Game> key = table_key(node, context->symmetric);
+  HashEntry* hash_entry = nullptr;
   if (hash_depth > 0) {
-    auto found = hash->emplace(node.key(), std::make_pair(-INT_MAX, INT_MAX));
+    auto found = hash->try_emplace(key.key);
     hash_entry = &found.first->second;
     if (!found.second) {
-      int ha = hash_entry->first;
-      int hb = hash_entry->second;
+      int ha = hash_entry->lower;
+      int hb = hash_entry->upper;
       if (hb <= alpha) return hb;
       if (ha >= beta) return ha;
       if (ha == hb) return ha;
@@ -159,7 +508,8 @@ int negascout_rec(const BoardImpl<Game>& node, int depth, int alpha, int beta,
 #ifdef USE_PROBCUT
 
   /* ProbCut */
-  const ProbCut* pc = probcut_entry(node, depth);
+  const ProbCut* pc =
+      context->options.probcut ? probcut_entry(node, depth) : nullptr;
 
   if (pc) {
     double thresh;
@@ -171,19 +521,19 @@ int negascout_rec(const BoardImpl<Game>& node, int depth, int alpha, int beta,
     if (beta < INT_MAX) {
       int bound = std::round((thresh * pc->sigma + beta - pc->b) / pc->a);
       int r = negascout_rec(node, pc->depth, bound - 1, bound, nullptr, hash,
-                            prev_hash, 0);
+                            prev_hash, 0, lists, context);
       if (r >= bound) {
-        if (hash_entry) hash_entry->first = std::max(hash_entry->first, beta);
+        if (hash_entry) hash_entry->lower = std::max(hash_entry->lower, beta);
         return beta;
       }
     }
     if (alpha > -INT_MAX) {
       int bound = std::round((-thresh * pc->sigma + alpha - pc->b) / pc->a);
       int r = negascout_rec(node, pc->depth, bound, bound + 1, nullptr, hash,
-                            prev_hash, 0);
+                            prev_hash, 0, lists, context);
       if (r <= bound) {
         if (hash_entry)
-          hash_entry->second = std::min(hash_entry->second, alpha);
+          hash_entry->upper = std::min(hash_entry->upper, alpha);
         return alpha;
       }
     }
@@ -191,58 +541,168 @@ int negascout_rec(const BoardImpl<Game>& node, int depth, int alpha, int beta,
 
 #endif  // USE_PROBCUT
 
-  // Territory evaluation costs more than the improved move ordering saves
-  // near the leaves. Keep it at the root and at internal nodes with at least
-  // three plies left, where it has the most impact on pruning.
-  const bool use_full_evaluation = depth > 2 || best_move != nullptr;
-  ChildCollector<Game> collector(node, prev_hash + 1, use_full_evaluation);
-  node.visit_moves(&collector);
-  std::vector<Child<Game>> children = std::move(collector.children);
-  std::vector<Child<Game>*> ordered_children;
-  ordered_children.reserve(children.size());
-  for (Child<Game>& child : children) ordered_children.push_back(&child);
-  std::sort(ordered_children.begin(), ordered_children.end(),
-            [](const Child<Game>* lhs, const Child<Game>* rhs) {
-              return lhs->score < rhs->score;
-            });
-
   bool found_pv = false;
   int score_max = -INT_MAX;
   int a = alpha;
+  int searched = 0;
+
+  // Searches a child. Returns true at a beta cutoff, with the value in
+  // score_max.
+  const auto search_child = [&](const BoardImpl<Game>& child, Move move) {
+    const int lmr_moves = context->options.lmr_moves;
+    if (lmr_moves > 0 && depth >= 3 && searched++ >= lmr_moves) {
+      // A late move that does not beat the best so far at reduced depth is
+      // not searched further. Like ProbCut's, the reduced search does not
+      // store its shallower bounds in the table.
+      const int score = -negascout_rec(
+          child, depth - 2, -a - 1, -a, nullptr, hash + 1, prev_hash + 1, 0,
+          child_move_lists(lists, move, depth - 2), context);
+      if (score <= a) {
+        score_max = std::max(score_max, score);
+        return false;
+      }
+    }
 
-  for (const Child<Game>* child : ordered_children) {
+    PathMoveList<Game>* child_lists =
+        child_move_lists(lists, move, depth - 1);
     int score;
     if (found_pv) {
-      score = -negascout_rec(child->board, depth - 1, -a - 1, -a, nullptr,
-                             hash + 1, prev_hash + 1, hash_depth - 1);
+      score = -negascout_rec(child, depth - 1, -a - 1, -a, nullptr, hash + 1,
+                             prev_hash + 1, hash_depth - 1, child_lists,
+                             context);
       if (score > a && score < beta) {
-        score = -negascout_rec(child->board, depth - 1, -beta, -score, nullptr,
-                               hash + 1, prev_hash + 1, hash_depth - 1);
+        score = -negascout_rec(child, depth - 1, -beta, -score, nullptr,
+                               hash + 1, prev_hash + 1, hash_depth - 1,
+                               child_lists, context);
       }
     } else {
-      score = -negascout_rec(child->board, depth - 1, -beta, -a, nullptr,
-                             hash + 1, prev_hash + 1, hash_depth - 1);
+      score = -negascout_rec(child, depth - 1, -beta, -a, nullptr, hash + 1,
+                             prev_hash + 1, hash_depth - 1, child_lists,
+                             context);
     }
 
     if (score >= beta) {
-      if (hash_entry) hash_entry->first = std::max(hash_entry->first, score);
-      return score;
+      context->ordering.add_cutoff(node, move, depth);
+      if (hash_entry) {
+        hash_entry->lower = std::max(hash_entry->lower, score);
+        hash_entry->best_move = key.convert(move);
+      }
+      score_max = score;
+      return true;
     }
 
     if (score > score_max) {
       if (score > a) a = score;
       if (score > alpha) {
         found_pv = true;
-        if (best_move) *best_move = child->move;
+        if (best_move) *best_move = move;
+        if (hash_entry) hash_entry->best_move = key.convert(move);
       }
       score_max = score;
     }
+    return false;
+  };
+
+  // Staged move generation: the best move found by an earlier search of this
+  // position comes first, and the other moves are only generated if it does
+  // not cut off. From the previous iteration, only the move of an exact value
+  // is used; a move that cut off a shallower search orders worse than the
+  // children's bounds do.
+  update_move_lists(node, lists);
+  Move hash_move = hash_entry ? key.convert(hash_entry->best_move) : Move();
+  if (!hash_move.is_valid()) {
+    auto found = prev_hash->find(key.key);
+    if (found != prev_hash->end() &&
+        found->second.lower == found->second.upper)
+      hash_move = key.convert(found->second.best_move);
+  }
+  if (hash_move.is_valid()) {
+    assert(node.is_valid_move(hash_move));
+    if (search_child(node.child(hash_move), hash_move)) return score_max;
+  }
+
+  // Territory evaluation costs more than the improved move ordering saves
+  // near the leaves. Keep it at the root and at internal nodes with at least
+  // three plies left, where it has the most impact on pruning. Nearer the
+  // leaves, the moves are ordered without making the child boards, and each
+  // board is only made if the search gets to it.
+  if (depth > 2 || best_move != nullptr) {
+    ChildCollector<Game> collector(node, prev_hash + 1, context->symmetric,
+                                   hash_move);
+    visit_moves(node, lists, &collector);
+    std::vector<Child<Game>> children = std::move(collector.children);
+    // Enhanced transposition cutoff: a child that this iteration has already
+    // met by another move order may be bounded well enough to cut off
+    // without searching anything. The children's entries exist, and hold
+    // bounds for this depth, only in a search that stores its own.
+    if (context->options.etc && hash_depth > 1) {
+      EtcStats* stats = context->options.etc_stats;
+      if (stats && stats->nodes.size() <= static_cast<size_t>(depth)) {
+        stats->nodes.resize(depth + 1);
+        stats->cutoffs.resize(depth + 1);
+      }
+      if (stats) stats->nodes[depth]++;
+      for (const Child<Game>& child : children) {
+        auto found = hash[1].find(child.key);
+        if (found == hash[1].end()) continue;
+        const int score = -found->second.upper;
+        if (score >= beta) {
+          if (stats) stats->cutoffs[depth]++;
+          context->ordering.add_cutoff(node, child.move, depth);
+          if (hash_entry) {
+            hash_entry->lower = std::max(hash_entry->lower, score);
+            hash_entry->best_move = key.convert(child.move);
+          }
+          return score;
+        }
+      }
+    }
+    std::vector<Child<Game>*> ordered_children;
+    ordered_children.reserve(children.size());
+    for (Child<Game>& child : children) ordered_children.push_back(&child);
+    std::sort(ordered_children.begin(), ordered_children.end(),
+              [](const Child<Game>* lhs, const Child<Game>* rhs) {
+                return std::tie(lhs->rank, lhs->score) <
+                       std::tie(rhs->rank, rhs->score);
+              });
+    if (context->options.multi_cut && best_move == nullptr &&
+        beta - alpha == 1 && depth >= MULTI_CUT.reduction + 2) {
+      int cuts = 0;
+      const int moves = std::min<int>(ordered_children.size(),
+                                      MULTI_CUT.moves);
+      for (int i = 0; i < moves; i++) {
+        const Child<Game>* child = ordered_children[i];
+        const int reduced = depth - 1 - MULTI_CUT.reduction;
+        const int score = -negascout_rec(
+            child->board, reduced, -beta, -alpha, nullptr, hash + 1,
+            prev_hash + 1, 0, child_move_lists(lists, child->move, reduced),
+            context);
+        if (score >= beta && ++cuts == MULTI_CUT.cuts) {
+          if (hash_entry) hash_entry->lower = std::max(hash_entry->lower, beta);
+          return beta;
+        }
+      }
+    }
+    for (const Child<Game>* child : ordered_children) {
+      if (search_child(child->board, child->move)) return score_max;
+    }
+  } else {
+    OrderedMoveCollector<Game> collector(node, context->ordering, hash_move);
+    visit_moves(node, lists, &collector);
+    std::sort(collector.moves.begin(), collector.moves.end(),
+              [](const auto& lhs, const auto& rhs) {
+                return lhs.first < rhs.first;
+              });
+    for (auto [order, move] : collector.moves) {
+      if (search_child(node.child(move), move)) return score_max;
+    }
   }
+
   if (hash_entry) {
     if (score_max > alpha)
-      hash_entry->first = hash_entry->second = score_max;
+      hash_entry->lower = hash_entry->upper = score_max;
     else
-      hash_entry->second = std::min(hash_entry->second, score_max);
+      hash_entry->upper = std::min(hash_entry->upper, score_max);
   }
   return score_max;
 }
@@ -251,22 +711,31 @@ template <class Game>
 int negascout_root(
     const BoardImpl<Game>& node, int depth,
     const std::unordered_map<Move, double, Move::Hash>* noise, Move* best_move,
-    Hash<Game>* hash, Hash<Game>* prev_hash) {
+    Hash<Game>* hash, Hash<Game>* prev_hash, SearchContext<Game>* context) {
   const auto move_noise = [&noise](Move move) {
     if (!noise) return 0.0;
     const auto found = noise->find(move);
     assert(found != noise->end());
     return found->second;
   };
-  ChildCollector<Game> collector(node, prev_hash + 1, true);
+  ChildCollector<Game> collector(node, prev_hash + 1, context->symmetric);
   node.visit_moves(&collector);
   std::vector<Child<Game>> children = std::move(collector.children);
+  // A move and its transpose lead to transposed positions of the same value.
+  // Keep the smaller of the two, unless noise tells them apart.
+  if (context->symmetric && !noise) {
+    std::erase_if(children, [](const Child<Game>& child) {
+      return BoardImpl<Game>::rotate_move(
+                 child.move, BoardImpl<Game>::TRANSPOSE) < child.move;
+    });
+  }
   std::vector<Child<Game>*> ordered_children;
   ordered_children.reserve(children.size());
   for (Child<Game>& child : children) ordered_children.push_back(&child);
   std::sort(
       ordered_children.begin(), ordered_children.end(),
       [&move_noise](const Child<Game>* lhs, const Child<Game>* rhs) {
+        if (lhs->rank != rhs->rank) return lhs->rank < rhs->rank;
         const double score_difference =
             static_cast<double>(lhs->score) - rhs->score;
         const double noise_difference =
@@ -274,17 +743,32 @@ int negascout_root(
         return score_difference < noise_difference;
       });
 
+  // The lists are kept only for an evaluator, whose leaf parents visit every
+  // move; with the built-in evaluation they mostly stop at an early cutoff,
+  // and updating the lists costs about as much as it saves. They start at the
+  // second turn: before that, the player to move at the children has no
+  // tiles, and visit_moves() works from their starting point instead.
+  PathMoveList<Game>* lists = nullptr;
+  if (context->options.evaluator && node.turn() >= 1) {
+    lists = context->move_lists.data();
+    lists[0] = {MoveList<Game>(node, node.player()), Move()};
+    lists[1] = {MoveList<Game>(node, node.opponent()), Move()};
+  }
+
   bool found_best = false;
   double best_bonus = 0;
   int best_score = -INT_MAX;
 
   for (const Child<Game>* child : ordered_children) {
     const double bonus = move_noise(child->move);
+    PathMoveList<Game>* child_lists =
+        child_move_lists(lists, child->move, depth - 1);
     int score;
 
     if (!found_best) {
       score = -negascout_rec(child->board, depth - 1, -INT_MAX, INT_MAX,
-                             nullptr, hash + 1, prev_hash + 1, 7);
+                             nullptr, hash + 1, prev_hash + 1, 7, child_lists,
+                             context);
     } else {
       const double required =
           best_score + std::floor(best_bonus - bonus) + 1;
@@ -292,15 +776,17 @@ int negascout_root(
 
       if (required <= -INT_MAX + 1) {
         score = -negascout_rec(child->board, depth - 1, -INT_MAX, INT_MAX,
-                               nullptr, hash + 1, prev_hash + 1, 7);
+                               nullptr, hash + 1, prev_hash + 1, 7,
+                               child_lists, context);
       } else {
         const int threshold = static_cast<int>(required);
         score = -negascout_rec(child->board, depth - 1, -threshold,
                                1 - threshold, nullptr, hash + 1, prev_hash + 1,
-                               7);
+                               7, child_lists, context);
         if (score < threshold) continue;
         score = -negascout_rec(child->board, depth - 1, -INT_MAX, -score,
-                               nullptr, hash + 1, prev_hash + 1, 7);
+                               nullptr, hash + 1, prev_hash + 1, 7,
+                               child_lists, context);
       }
     }
 
@@ -320,20 +806,25 @@ int negascout_root(
 
 template <class Game>
 SearchResult negascout(const BoardImpl<Game>& node, int max_depth,
-                       std::function<bool(int, SearchResult)> callback) {
-  return negascout_gumbel(node, max_depth, 0, 0, std::move(callback));
+                       std::function<bool(int, SearchResult)> callback,
+                       const SearchOptions<Game>& options) {
+  return negascout_gumbel(node, max_depth, 0, 0, std::move(callback),
+                          options);
 }
 template SearchResult negascout<BlokusDuoMini>(
     const BoardImpl<BlokusDuoMini>& node, int max_depth,
-    std::function<bool(int, SearchResult)> callback);
+    std::function<bool(int, SearchResult)> callback,
+    const SearchOptions<BlokusDuoMini>& options);
 template SearchResult negascout<BlokusDuoStandard>(
     const BoardImpl<BlokusDuoStandard>& node, int max_depth,
-    std::function<bool(int, SearchResult)> callback);
+    std::function<bool(int, SearchResult)> callback,
+    const SearchOptions<BlokusDuoStandard>& options);
 
 template <class Game>
-SearchResult negascout_gumbel(
-    const BoardImpl<Game>& node, int max_depth, double temperature,
-    uint64_t seed, std::function<bool(int, SearchResult)> callback) {
+SearchResult negascout_gumbel(const BoardImpl<Game>& node, int max_depth,
+                              double temperature, uint64_t seed,
+                              std::function<bool(int, SearchResult)> callback,
+                              const SearchOptions<Game>& options) {
   assert(max_depth >= 2);
   assert(std::isfinite(temperature));
   assert(temperature >= 0);
@@ -353,10 +844,13 @@ SearchResult negascout_gumbel(
 
   Move best_move;
   int score;
+  SearchContext<Game> context(options);
+  if (options.evaluator) context.move_lists.resize(max_depth + 1);
+  context.symmetric = options.symmetry && node.transposed_key() == node.key();
 
 #ifdef PROBSTAT
-  score =
-      negascout_rec(node, 1, -INT_MAX, INT_MAX, nullptr, nullptr, nullptr, 0);
+  score = negascout_rec(node, 1, -INT_MAX, INT_MAX, nullptr, nullptr, nullptr,
+                        0, nullptr, &context);
   printf("1> ? ???? (%d)\n", score);
 #endif
 
@@ -365,7 +859,7 @@ SearchResult negascout_gumbel(
   for (int depth = 2; depth <= max_depth; depth++) {
     hash = std::make_unique<Hash<Game>[]>(max_depth);
     score = negascout_root(node, depth, noise_ptr, &best_move, hash.get(),
-                           previous_hash.get());
+                           previous_hash.get(), &context);
     previous_hash = std::move(hash);
     if (!callback(depth, SearchResult(best_move, score))) break;
   }
@@ -373,24 +867,390 @@ SearchResult negascout_gumbel(
 }
 template SearchResult negascout_gumbel<BlokusDuoMini>(
     const BoardImpl<BlokusDuoMini>& node, int max_depth, double temperature,
-    uint64_t seed, std::function<bool(int, SearchResult)> callback);
+    uint64_t seed, std::function<bool(int, SearchResult)> callback,
+    const SearchOptions<BlokusDuoMini>& options);
 template SearchResult negascout_gumbel<BlokusDuoStandard>(
     const BoardImpl<BlokusDuoStandard>& node, int max_depth,
     double temperature, uint64_t seed,
-    std::function<bool(int, SearchResult)> callback);
+    std::function<bool(int, SearchResult)> callback,
+    const SearchOptions<BlokusDuoStandard>& options);
+
+// Bounds on the value of a searched position. A fail-hard search only
+// bounds the value when it falls outside the window, so a single value
+// could not be reused by searches with other windows.
+struct ValueBounds {
+  int lower = -INT_MAX;
+  int upper = INT_MAX;
+
+  // Converts between the points of view of violet and the player to move.
+  ValueBounds for_player(bool violet) const {
+    return violet ? *this : ValueBounds{-upper, -lower};
+  }
+};
 
 template <class Game>
-using WldHash = std::unordered_map<typename BoardImpl<Game>::Key, int,
+using WldHash = std::unordered_map<typename BoardImpl<Game>::Key, ValueBounds,
                                    typename BoardImpl<Game>::Key::Hash>;
 
+// Bounds the gain in score of `player` until the end of the game: each tile
+// they place needs both an unplaced piece and a reachable cell. Only a
+// result of at most `limit`, the largest gain that allows a cutoff, is
+// exact: the flood fill of reachable cells is skipped if the unplaced pieces
+// are small enough, and stops once it has reached more than `limit` cells.
+template <class Game>
+int max_gain(const BoardImpl<Game>& node, int player, int limit) {
+  if (node.did_pass(player)) return 0;
+  int pieces = 0;
+  for (int i = 0; i < Game::NUM_PIECES; i++) {
+    if (node.is_piece_available(player, i)) pieces += block_set[i].size;
+  }
+  if (pieces <= limit) return pieces;
+  int cells = 0;
+  for (uint16_t row : node.reachable_rows(player, limit))
+    cells += std::popcount(row);
+  return std::min(pieces, cells);
+}
+
+// Returns whether the final relative_score() of `node`, for the player to
+// move, is certainly at most `alpha` or at least `beta`, and if so stores
+// the bound that shows it in `bounds`.
+template <class Game>
+bool outside_window(const BoardImpl<Game>& node, int alpha, int beta,
+                    ValueBounds* bounds) {
+  const int me = node.is_violet_turn() ? 0 : 1;
+  const int current = node.score(me) - node.score(1 - me);
+  if (current <= alpha) {
+    bounds->upper = current + max_gain(node, me, alpha - current);
+    if (bounds->upper <= alpha) return true;
+  }
+  if (current >= beta) {
+    bounds->lower = current - max_gain(node, 1 - me, current - beta);
+    if (bounds->lower >= beta) return true;
+  }
+  return false;
+}
+
+// Splits `cells` into components connected by king steps, in row order.
+template <size_t N>
+std::vector<std::array<uint16_t, N>> split_regions(
+    std::array<uint16_t, N> cells) {
+  std::vector<std::array<uint16_t, N>> regions;
+  for (size_t first = 0; first < N;) {
+    if (cells[first] == 0) {
+      first++;
+      continue;
+    }
+    std::array<uint16_t, N> region = {};
+    region[first] = cells[first] & -cells[first];
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (size_t y = first; y < N; y++) {
+        uint16_t span = region[y];
+        if (y > 0) span |= region[y - 1];
+        if (y + 1 < N) span |= region[y + 1];
+        const uint16_t grown = (span | (span << 1) | (span >> 1)) & cells[y];
+        if (grown != region[y]) {
+          region[y] = grown;
+          changed = true;
+        }
+      }
+    }
+    for (size_t y = first; y < N; y++) cells[y] &= ~region[y];
+    regions.push_back(region);
+  }
+  return regions;
+}
+
+// Memo of solo_rec(): bounds on the most tiles the player to move can still
+// place on the allowed cells. Only their own tiles on and around those cells
+// matter, so positions that differ elsewhere share entries.
+template <class Game>
+struct SoloKey {
+  struct Hash {
+    size_t operator()(const SoloKey& key) const noexcept {
+      return std::hash<std::string_view>{}(std::string_view(
+          reinterpret_cast<const char*>(&key), sizeof(SoloKey)));
+    }
+  };
+  bool operator==(const SoloKey& rhs) const noexcept {
+    return memcmp(this, &rhs, sizeof(SoloKey)) == 0;
+  }
+
+  uint32_t pieces;  // Placed pieces.
+  std::array<uint16_t, BoardImpl<Game>::YSIZE> allowed;
+  std::array<uint16_t, BoardImpl<Game>::YSIZE> tiles;
+};
+template <class Game>
+using SoloHash = std::unordered_map<SoloKey<Game>, ValueBounds,
+                                    typename SoloKey<Game>::Hash>;
+
+// State shared by the nodes of one wld() or perfect() call.
+template <class Game>
+struct EndgameContext {
+  explicit EndgameContext(const EndgameOptions& o)
+      : options(o),
+        deadline(std::chrono::steady_clock::now() +
+                 std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::duration<double>(o.seconds))) {}
+
+  // Returns whether EndgameOptions::seconds has run out. Once it has, every
+  // node returns at once, and the root discards the result.
+  bool out_of_time() {
+    if (options.seconds <= 0) return false;
+    if (!timed_out && ++nodes % 256 == 0)
+      timed_out = std::chrono::steady_clock::now() >= deadline;
+    return timed_out;
+  }
+
+  const EndgameOptions& options;
+  SoloHash<Game> solo_hash;
+  std::chrono::steady_clock::time_point deadline;
+  unsigned nodes = 0;
+  bool timed_out = false;
+};
+
+// Returns whether some cell of `move` is in `cells`. The cells of a legal
+// move are all in the same region, so checking one of them is enough.
+template <size_t N>
+bool move_touches(Move move, const std::array<uint16_t, N>& cells) {
+  const auto& rotation =
+      block_set[move.piece_id()].rotations[move.orientation()];
+  const Piece* piece = rotation.piece;
+  const int x = move.x() + rotation.offset_x + piece->coords[0].x;
+  const int y = move.y() + rotation.offset_y + piece->coords[0].y;
+  return cells[y] >> x & 1;
+}
+
+// The tile totals that some subset of the pieces of `player` adds up to.
+template <class Game>
+using PieceSums = std::bitset<Game::XSIZE * Game::YSIZE + 1>;
+
+template <class Game>
+PieceSums<Game> piece_sums(const BoardImpl<Game>& board, int player) {
+  PieceSums<Game> sums = 1;
+  for (int i = 0; i < Game::NUM_PIECES; i++) {
+    if (board.is_piece_available(player, i)) sums |= sums << block_set[i].size;
+  }
+  return sums;
+}
+
+// Returns the largest of `sums` that is at most `cells`.
+template <class Game>
+int fill(const PieceSums<Game>& sums, int cells) {
+  while (!sums[cells]) cells--;
+  return cells;
+}
+
+// Searches the placements of the player to move in regions[region] and the
+// regions after it, as if the opponent never moved again, for the most tiles
+// they can place. Moves in different regions do not interact, so each region
+// is finished before the next one instead of trying every interleaving: the
+// player either places another piece in the current region or leaves it for
+// good. Like perfect_rec(), the result is exact only inside (lo, hi), and is
+// lo or hi otherwise.
+// `moves` holds the valid moves of `board` if they are already known.
+template <class Game>
+int solo_rec(const BoardImpl<Game>& board,
+             const std::vector<std::array<uint16_t, Game::YSIZE>>& regions,
+             size_t region, int lo, int hi, EndgameContext<Game>* context,
+             std::vector<Move>* moves = nullptr) {
+  SoloHash<Game>* hash = &context->solo_hash;
+  if (region == regions.size()) return std::clamp(0, lo, hi);
+  constexpr uint16_t ROW_MASK = (uint16_t{1} << Game::XSIZE) - 1;
+  SoloKey<Game> key = {};
+  for (int i = 0; i < Game::NUM_PIECES; i++) {
+    if (!board.is_piece_available(board.player(), i)) key.pieces |= 1u << i;
+  }
+  // Placing pieces closes the cells they cover and their edge neighbors.
+  std::array<uint16_t, Game::YSIZE> own, open;
+  for (int y = 0; y < Game::YSIZE; y++)
+    own[y] = board.key().a[board.player()][y] & ROW_MASK;
+  for (int y = 0; y < Game::YSIZE; y++) {
+    uint16_t closed = board.key().a[board.opponent()][y] | own[y] |
+                      own[y] << 1 | own[y] >> 1;
+    if (y > 0) closed |= own[y - 1];
+    if (y + 1 < Game::YSIZE) closed |= own[y + 1];
+    open[y] = ~closed;
+  }
+  for (size_t r = region; r < regions.size(); r++) {
+    for (int y = 0; y < Game::YSIZE; y++)
+      key.allowed[y] |= regions[r][y] & open[y];
+  }
+  for (int y = 0; y < Game::YSIZE; y++) {
+    uint16_t span = key.allowed[y];
+    if (y > 0) span |= key.allowed[y - 1];
+    if (y + 1 < Game::YSIZE) span |= key.allowed[y + 1];
+    key.tiles[y] = (span | (span << 1) | (span >> 1)) &
+                   own[y];
+  }
+  auto i = hash->find(key);
+  if (i != hash->end()) {
+    const ValueBounds b = i->second;
+    if (b.upper <= lo) return lo;
+    if (b.lower >= hi) return hi;
+    if (b.lower == b.upper) return b.lower;
+  }
+
+  // Branch and bound on the piece sizes: the tiles placed in each region add
+  // up to a subset of the unplaced pieces that fits in its cells, and so do
+  // the tiles placed in all of them.
+  const PieceSums<Game> sums = piece_sums(board, board.player());
+  int capacity = 0;
+  for (size_t r = region; r < regions.size(); r++) {
+    int cells = 0;
+    for (int y = 0; y < Game::YSIZE; y++)
+      cells += std::popcount(static_cast<uint16_t>(regions[r][y] & open[y]));
+    capacity += fill<Game>(sums, cells);
+  }
+  const int limit = fill<Game>(sums, capacity);
+  ValueBounds bounds;
+  if (limit <= lo) {
+    bounds.upper = limit;
+    (*hash)[key] = bounds;
+    return lo;
+  }
+
+  std::vector<Move> own_moves;
+  if (!moves) {
+    ++visited_nodes;
+    if (context->out_of_time()) return lo;
+    own_moves = board.valid_moves();
+    // Larger pieces first: they reach the bound sooner, and the small pieces
+    // can often still fill the gaps they leave.
+    std::stable_sort(own_moves.begin(), own_moves.end(), [](Move a, Move b) {
+      return !a.is_pass() &&
+             (b.is_pass() ||
+              block_set[a.piece_id()].size > block_set[b.piece_id()].size);
+    });
+    moves = &own_moves;
+  }
+  int best = solo_rec(board, regions, region + 1, lo, hi, context, moves);
+  if (best < hi && best < limit) {
+    for (Move move : *moves) {
+      if (move.is_pass() || !move_touches(move, regions[region])) continue;
+      // The opponent's pass only hands the turn back.
+      const BoardImpl<Game> child = board.child(move).child(Move::pass());
+      const int size = block_set[move.piece_id()].size;
+      best = std::max(best, size + solo_rec(child, regions, region,
+                                            best - size, hi - size, context));
+      if (best >= hi || best == limit) break;
+    }
+  }
+  if (best >= hi) {
+    bounds.lower = hi;
+    (*hash)[key] = bounds;
+    return hi;
+  }
+  if (best > lo) bounds.lower = best;
+  bounds.upper = best;
+  (*hash)[key] = bounds;
+  return best;
+}
+
+// If a player has passed for good, or neither player can reach a cell that
+// the other can, their moves no longer interact, and each of them will place
+// as many tiles as they can on their own. In that case, stores the final
+// relative_score() in `value` if it is inside (alpha, beta), or alpha or beta
+// if the value is outside, and returns true.
+template <class Game>
+bool solve_separated(const BoardImpl<Game>& node, int alpha, int beta,
+                     EndgameContext<Game>* context, int* value) {
+  if (node.turn() < 2) return false;
+  const int me = node.player(), opponent = node.opponent();
+  const EndgameOptions& options = context->options;
+  if (node.did_pass(me) || node.did_pass(opponent)) {
+    if (!options.single_player) return false;
+  } else if (!options.split_regions) {
+    return false;
+  }
+  // Flood fills stop at the first shared cell. Usually the opponent reaches
+  // the cells next to my anchors, the first cells of my flood fill.
+  constexpr int CELLS = Game::XSIZE * Game::YSIZE;
+  const auto overlap = [](const auto& a, const auto& b) {
+    for (int y = 0; y < Game::YSIZE; y++) {
+      if (a[y] & b[y]) return true;
+    }
+    return false;
+  };
+  std::array<uint16_t, Game::YSIZE> mine = {}, theirs = {};
+  if (node.did_pass(me)) {
+    theirs = node.reachable_rows(opponent);
+  } else if (node.did_pass(opponent)) {
+    mine = node.reachable_rows(me);
+  } else {
+    mine = node.reachable_rows(me, 0);
+    theirs = node.reachable_rows(opponent, CELLS, mine);
+    if (overlap(mine, theirs)) return false;
+    mine = node.reachable_rows(me, CELLS, theirs);
+    if (overlap(mine, theirs)) return false;
+  }
+  // Without the region split, each player's area is solved as one region.
+  const auto regions = [&](const std::array<uint16_t, Game::YSIZE>& cells) {
+    if (options.split_regions) return split_regions(cells);
+    return std::vector<std::array<uint16_t, Game::YSIZE>>{cells};
+  };
+  // Narrow an infinite window so that the arithmetic below cannot overflow;
+  // scores differ by less than the number of cells.
+  alpha = std::max(alpha, -CELLS);
+  beta = std::min(beta, CELLS);
+  // The value is current + my_gain - their_gain, and my_gain is at most the
+  // size of my reachable area. Solve their gain first, in the range where it
+  // can still decide the value.
+  const int current = node.score(me) - node.score(opponent);
+  int capacity = 0;
+  for (uint16_t row : mine) capacity += std::popcount(row);
+  const int their_lo = current - beta, their_hi = current + capacity - alpha;
+  const int their_gain =
+      solo_rec(node.child(Move::pass()), regions(theirs), 0, their_lo,
+               their_hi, context);
+  if (their_gain >= their_hi) {
+    *value = alpha;
+  } else if (their_gain <= their_lo) {
+    *value = beta;
+  } else {
+    const int base = current - their_gain;
+    *value = base + solo_rec(node, regions(mine), 0, alpha - base,
+                             beta - base, context);
+  }
+  return true;
+}
+
 template <class Game>
 int wld_rec(const BoardImpl<Game>& node, int alpha, int beta,
-            WldHash<Game>* hash) {
+            WldHash<Game>* hash, EndgameContext<Game>* context) {
   typename BoardImpl<Game>::Key key(node.key());
   auto i = hash->find(key);
-  if (i != hash->end()) return node.is_violet_turn() ? i->second : -i->second;
+  if (i != hash->end()) {
+    const ValueBounds b = i->second.for_player(node.is_violet_turn());
+    if (b.lower == b.upper) return b.lower;
+    if (b.upper <= std::max(alpha, -1)) return std::max(b.upper, alpha);
+    if (b.lower >= std::min(beta, 1)) return std::min(b.lower, beta);
+  }
 
   ++visited_nodes;
+  if (context->out_of_time()) return alpha;
+
+  if (context->options.capacity_bounds) {
+    // Only the sign of a wld_rec() value is exact, so a bound that settles
+    // the outcome is as good as the searched value.
+    ValueBounds bounds;
+    if (outside_window(node, std::max(alpha, -1), std::min(beta, 1),
+                       &bounds)) {
+      (*hash)[key] = bounds.for_player(node.is_violet_turn());
+      return bounds.upper < INT_MAX ? std::max(bounds.upper, alpha)
+                                    : std::min(bounds.lower, beta);
+    }
+  }
+
+  int value;
+  const int lo = std::max(alpha, -1), hi = std::min(beta, 1);
+  if (solve_separated(node, lo, hi, context, &value)) {
+    ValueBounds bounds;
+    if (value > lo) bounds.lower = value;
+    if (value < hi) bounds.upper = value;
+    (*hash)[key] = bounds.for_player(node.is_violet_turn());
+    return value;
+  }
 
   std::vector<Move> valid_moves = node.valid_moves();
   if (valid_moves[0].is_pass()) {
@@ -406,21 +1266,30 @@ int wld_rec(const BoardImpl<Game>& node, int alpha, int beta,
     }
   }
 
+  const int original_alpha = alpha;
+  ValueBounds bounds;
   for (Move move : valid_moves) {
     auto child = node.child(move);
-    int v = -wld_rec(child, -beta, -alpha, hash + 1);
+    int v = -wld_rec(child, -beta, -alpha, hash + 1, context);
     if (v > alpha) {
       alpha = v;
       if (alpha > 0 || alpha >= beta) break;
     }
   }
-  (*hash)[key] = node.is_violet_turn() ? alpha : -alpha;
+  if (alpha > 0 || alpha >= beta)
+    bounds.lower = alpha;
+  else if (alpha > original_alpha)
+    bounds.lower = bounds.upper = alpha;
+  else
+    bounds.upper = alpha;
+  (*hash)[key] = bounds.for_player(node.is_violet_turn());
   return alpha;
 }
 
 template <class Game>
-SearchResult wld(const BoardImpl<Game>& node) {
+SearchResult wld(const BoardImpl<Game>& node, const EndgameOptions& options) {
   WldHash<Game> hash[42];
+  EndgameContext<Game> context(options);
   visited_nodes++;
 
   int alpha = -INT_MAX, beta = INT_MAX;
@@ -429,7 +1298,8 @@ SearchResult wld(const BoardImpl<Game>& node) {
 
   for (Move move : valid_moves) {
     BoardImpl<Game> child = node.child(move);
-    int v = -wld_rec(child, -beta, -alpha, hash);
+    int v = -wld_rec(child, -beta, -alpha, hash, &context);
+    if (context.timed_out) return SearchResult(Move(), 0);
     if (v > alpha) {
       alpha = v;
       wld_move = move;
@@ -438,42 +1308,75 @@ SearchResult wld(const BoardImpl<Game>& node) {
   }
   return SearchResult(wld_move, alpha);
 }
-template SearchResult wld<BlokusDuoMini>(const BoardImpl<BlokusDuoMini>& node);
+template SearchResult wld<BlokusDuoMini>(const BoardImpl<BlokusDuoMini>& node,
+                                         const EndgameOptions& options);
 template SearchResult wld<BlokusDuoStandard>(
-    const BoardImpl<BlokusDuoStandard>& node);
+    const BoardImpl<BlokusDuoStandard>& node, const EndgameOptions& options);
 
 template <class Game>
 int perfect_rec(const BoardImpl<Game>& node, int alpha, int beta,
-                WldHash<Game>* hash) {
+                WldHash<Game>* hash, EndgameContext<Game>* context) {
   typename BoardImpl<Game>::Key key(node.key());
   auto i = hash->find(key);
-  if (i != hash->end()) return node.is_violet_turn() ? i->second : -i->second;
+  if (i != hash->end()) {
+    const ValueBounds b = i->second.for_player(node.is_violet_turn());
+    if (b.upper <= alpha) return alpha;
+    if (b.lower >= beta) return beta;
+    if (b.lower == b.upper) return b.lower;
+  }
 
   visited_nodes++;
+  if (context->out_of_time()) return alpha;
+
+  if (context->options.capacity_bounds) {
+    // Fail-hard cutoffs, returning what the search would return.
+    ValueBounds bounds;
+    if (outside_window(node, alpha, beta, &bounds)) {
+      (*hash)[key] = bounds.for_player(node.is_violet_turn());
+      return bounds.upper < INT_MAX ? alpha : beta;
+    }
+  }
+
+  int value;
+  if (solve_separated(node, alpha, beta, context, &value)) {
+    ValueBounds bounds;
+    if (value > alpha) bounds.lower = value;
+    if (value < beta) bounds.upper = value;
+    (*hash)[key] = bounds.for_player(node.is_violet_turn());
+    return value;
+  }
 
+  const int original_alpha = alpha;
+  ValueBounds bounds;
   for (Move move : node.valid_moves()) {
     BoardImpl<Game> child = node.child(move);
     if (child.is_game_over()) {
       assert(move.is_pass());
       return node.relative_score();
     }
-    int v = -perfect_rec(child, -beta, -alpha, hash + 1);
+    int v = -perfect_rec(child, -beta, -alpha, hash + 1, context);
     if (v > alpha) {
       alpha = v;
       if (alpha >= beta) {
-        (*hash)[key] = node.is_violet_turn() ? beta : -beta;
+        bounds.lower = beta;
+        (*hash)[key] = bounds.for_player(node.is_violet_turn());
         return beta;
       }
     }
   }
-  (*hash)[key] = node.is_violet_turn() ? alpha : -alpha;
+  if (alpha > original_alpha)
+    bounds.lower = alpha;
+  bounds.upper = alpha;
+  (*hash)[key] = bounds.for_player(node.is_violet_turn());
   return alpha;
 }
 
 template <class Game>
-SearchResult perfect(const BoardImpl<Game>& node) {
+SearchResult perfect(const BoardImpl<Game>& node,
+                     const EndgameOptions& options) {
   constexpr int max_turn = Game::NUM_PIECES * 2 + 2;
   auto hash = std::make_unique<WldHash<Game>[]>(max_turn - node.turn());
+  EndgameContext<Game> context(options);
 
   visited_nodes++;
 
@@ -481,7 +1384,8 @@ SearchResult perfect(const BoardImpl<Game>& node) {
   Move perfect_move;
   for (Move move : node.valid_moves()) {
     auto child = node.child(move);
-    int v = -perfect_rec(child, -beta, -alpha, hash.get());
+    int v = -perfect_rec(child, -beta, -alpha, hash.get(), &context);
+    if (context.timed_out) return SearchResult(Move(), 0);
     if (v > alpha) {
       alpha = v;
       perfect_move = move;
@@ -490,9 +1394,135 @@ SearchResult perfect(const BoardImpl<Game>& node) {
   return SearchResult(perfect_move, alpha);
 }
 template SearchResult perfect<BlokusDuoMini>(
-    const BoardImpl<BlokusDuoMini>& node);
+    const BoardImpl<BlokusDuoMini>& node, const EndgameOptions& options);
 template SearchResult perfect<BlokusDuoStandard>(
-    const BoardImpl<BlokusDuoStandard>& node);
+    const BoardImpl<BlokusDuoStandard>& node, const EndgameOptions& options);
+
+// Counts the moves of a position, and picks one of them uniformly at random.
+struct TreeEstimate {
+  double size = 0;
+  // The positions whose moves the probes visited.
+  long positions = 0;
+};
+
+template <class Game>
+TreeEstimate probe_tree(const BoardImpl<Game>& node, int probes,
+                        uint64_t seed) {
+  std::mt19937_64 random(seed);
+  TreeEstimate estimate;
+  for (int i = 0; i < probes; i++) {
+    BoardImpl<Game> board = node;
+    double width = 1, size = 1;
+    while (!board.is_game_over()) {
+      RandomMoveVisitor<Game> visitor(&random);
+      board.visit_moves(&visitor);
+      estimate.positions++;
+      width *= std::max<uint64_t>(visitor.count, 1);
+      size += width;
+      board.play_move(visitor.move);
+    }
+    estimate.size += size / probes;
+  }
+  return estimate;
+}
+
+template <class Game>
+double estimate_tree_size(const BoardImpl<Game>& node, int probes,
+                          uint64_t seed) {
+  return probe_tree(node, probes, seed).size;
+}
+template double estimate_tree_size<BlokusDuoMini>(
+    const BoardImpl<BlokusDuoMini>& node, int probes, uint64_t seed);
+template double estimate_tree_size<BlokusDuoStandard>(
+    const BoardImpl<BlokusDuoStandard>& node, int probes, uint64_t seed);
+
+// The predicted time of an endgame search is `scale * size^exponent` times
+// the time the probes took per position, where `size` is the
+// estimate_tree_size() of the position, from 64 probes. Fitted by least
+// squares in log-log space to the searches that finished within 5 to 10
+// seconds, of the positions of 30 Mini games from turn 2 and 24 Standard
+// games from turn 18 or 19, played by shallow NegaScout before those turns
+// and at random after them. Most predictions are within a factor of 2 for
+// perfect search, but only about two thirds for WLD search, whose cost
+// depends more on how clearly the game is decided.
+struct EndgameCost {
+  double scale;
+  double exponent;
+
+  double seconds(const TreeEstimate& estimate, double probe_seconds) const {
+    return probe_seconds / std::max(estimate.positions, 1L) * scale *
+           std::pow(estimate.size, exponent);
+  }
+};
+
+template <class Game>
+constexpr EndgameCost WLD_COST = std::is_same_v<Game, BlokusDuoMini>
+                                     ? EndgameCost{7.0, 0.36}
+                                     : EndgameCost{78, 0.23};
+template <class Game>
+constexpr EndgameCost PERFECT_COST = std::is_same_v<Game, BlokusDuoMini>
+                                         ? EndgameCost{14, 0.41}
+                                         : EndgameCost{41, 0.38};
+
+template <class Game>
+SearchResult auto_search(const BoardImpl<Game>& node,
+                         const AutoSearchOptions<Game>& options) {
+  const auto start = std::chrono::steady_clock::now();
+  const auto elapsed = [](std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         since)
+        .count();
+  };
+  const auto remaining = [&] { return options.seconds - elapsed(start); };
+
+  AutoSearchInfo info;
+  const TreeEstimate estimate = probe_tree(node, options.probes, options.seed);
+  const double probe_seconds = elapsed(start);
+  info.tree_size = estimate.size;
+  info.wld_seconds = WLD_COST<Game>.seconds(estimate, probe_seconds);
+  info.perfect_seconds = PERFECT_COST<Game>.seconds(estimate, probe_seconds);
+
+  // An endgame search may take a few times longer than predicted. Give it
+  // up to three quarters of the time left, and keep the rest for NegaScout
+  // if it runs out.
+  const auto try_endgame = [&](SearchKind kind, double predicted,
+                               SearchResult* result) {
+    if (predicted > remaining() / 2) return false;
+    EndgameOptions endgame = options.endgame;
+    endgame.seconds = remaining() * 3 / 4;
+    *result = kind == SearchKind::PERFECT ? perfect(node, endgame)
+                                          : wld(node, endgame);
+    if (result->first.is_valid()) {
+      info.kind = kind;
+      return true;
+    }
+    info.fell_back = true;
+    return false;
+  };
+  SearchResult result;
+  if (!try_endgame(SearchKind::PERFECT, info.perfect_seconds, &result) &&
+      !try_endgame(SearchKind::WLD, info.wld_seconds, &result)) {
+    // Like match, iterative deepening stops when the next iteration, which
+    // takes at least as long again, would not fit.
+    const auto negascout_start = std::chrono::steady_clock::now();
+    const double seconds = remaining();
+    info.kind = SearchKind::NEGASCOUT;
+    result = negascout(
+        node, 20,
+        [&](int, SearchResult) {
+          return elapsed(negascout_start) < seconds / 2;
+        },
+        options.negascout);
+  }
+  if (options.info) *options.info = info;
+  return result;
+}
+template SearchResult auto_search<BlokusDuoMini>(
+    const BoardImpl<BlokusDuoMini>& node,
+    const AutoSearchOptions<BlokusDuoMini>& options);
+template SearchResult auto_search<BlokusDuoStandard>(
+    const BoardImpl<BlokusDuoStandard>& node,
+    const AutoSearchOptions<BlokusDuoStandard>& options);
 
 template <>
 Move opening_move<BlokusDuoMini>(const BoardImpl<BlokusDuoMini>&) {
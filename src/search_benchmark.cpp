@@ -2,41 +2,16 @@
 #include <time.h>
 
 #include "blokusduo.h"
+#include "search_move.h"
 
 namespace blokusduo::search {
 namespace {
 
 template <class Game>
-Move search_move(const BoardImpl<Game>& b);
-
-template <>
-Move search_move(const BoardImpl<BlokusDuoMini>& b) {
-  Move move = opening_move(b);
-  if (move.is_valid()) return move;
-  SearchResult r;
-  if (b.turn() < 5)
-    r = negascout(b, b.turn() + 3, [](int, SearchResult) { return true; });
-  else if (b.turn() < 7)
-    r = wld(b);
-  else
-    r = perfect(b);
-  return r.first;
-}
-
-template <>
-Move search_move(const BoardImpl<BlokusDuoStandard>& b) {
-  int max_depth = b.turn() < 10 ? 3 : b.turn() < 16 ? 4 : b.turn() < 20 ? 5 : 6;
-
+Move benchmark_move(const BoardImpl<Game>& b) {
   Move move = opening_move(b);
   if (move.is_valid()) return move;
-  SearchResult r;
-  if (b.turn() < 21)
-    r = negascout(b, max_depth, [](int, SearchResult) { return true; });
-  else if (b.turn() < 25)
-    r = wld(b);
-  else
-    r = perfect(b);
-  return r.first;
+  return search_move(b).first;
 }
 
 }  // namespace
@@ -48,7 +23,7 @@ void playout() {
     clock_t start = clock();
     visited_nodes = 0;
 
-    Move m = search_move(b);
+    Move m = benchmark_move(b);
     b.play_move(m);
 
     double sec = (double)(clock() - start) / CLOCKS_PER_SEC;
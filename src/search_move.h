@@ -0,0 +1,60 @@
+#ifndef SEARCH_MOVE_H_
+#define SEARCH_MOVE_H_
+
+#include <stdint.h>
+
+#include "blokusduo.h"
+
+namespace blokusduo::search {
+
+// SplitMix64 finalizer, used by self-play and matches to derive independent
+// game and move seeds from one seed.
+inline uint64_t mix_seed(uint64_t x) {
+  x += 0x9e3779b97f4a7c15;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+  return x ^ (x >> 31);
+}
+
+// The staging used by search_move(): NegaScout to depth_schedule() before
+// WLD_TURN, then win/loss/draw search before PERFECT_TURN, then perfect
+// search. The thresholds are examples tuned for a desktop CPU.
+template <class Game>
+struct MoveSchedule;
+
+template <>
+struct MoveSchedule<BlokusDuoMini> {
+  static constexpr int WLD_TURN = 5;
+  static constexpr int PERFECT_TURN = 7;
+  static int depth(int turn) { return turn + 3; }
+};
+
+template <>
+struct MoveSchedule<BlokusDuoStandard> {
+  static constexpr int WLD_TURN = 21;
+  static constexpr int PERFECT_TURN = 25;
+  static int depth(int turn) {
+    return turn < 10 ? 3 : turn < 16 ? 4 : turn < 20 ? 5 : 6;
+  }
+};
+
+// Chooses a move by turn-based staging: NegaScout with a depth schedule in
+// the opening and middlegame, then win/loss/draw search, then perfect search.
+// `temperature` and `seed` are passed to negascout_gumbel(); the endgame
+// searches are deterministic.
+template <class Game>
+SearchResult search_move(const BoardImpl<Game>& b, double temperature = 0,
+                         uint64_t seed = 0) {
+  using Schedule = MoveSchedule<Game>;
+  if (b.turn() < Schedule::WLD_TURN)
+    return negascout_gumbel(b, Schedule::depth(b.turn()), temperature, seed,
+                            [](int, SearchResult) { return true; });
+  else if (b.turn() < Schedule::PERFECT_TURN)
+    return wld(b);
+  else
+    return perfect(b);
+}
+
+}  // namespace blokusduo::search
+
+#endif  // SEARCH_MOVE_H_
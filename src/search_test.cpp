@@ -8,6 +8,7 @@
 #include <gtest/gtest.h>
 
 #include "blokusduo.h"
+#include "blokusduo_evaluator.h"
 
 namespace blokusduo::search {
 namespace {
@@ -20,6 +21,27 @@ int depth_two_score(const mini::Board& board, Move move) {
   return score;
 }
 
+template <class Game>
+int negamax(const BoardImpl<Game>& board, int depth) {
+  if (depth == 0) return board.nega_eval();
+  int score = -INT_MAX;
+  for (Move move : board.valid_moves())
+    score = std::max(score, -negamax(board.child(move), depth - 1));
+  return score;
+}
+
+// Fail-hard alpha-beta to the end of the game, without a hash table.
+template <class Game>
+int final_score(const BoardImpl<Game>& board, int alpha, int beta) {
+  for (Move move : board.valid_moves()) {
+    const BoardImpl<Game> child = board.child(move);
+    if (child.is_game_over()) return board.relative_score();
+    alpha = std::max(alpha, -final_score(child, -beta, -alpha));
+    if (alpha >= beta) return beta;
+  }
+  return alpha;
+}
+
 TEST(NegaScoutGumbel, ZeroTemperatureMatchesNegaScout) {
   mini::Board board;
   const auto callback = [](int, SearchResult) { return true; };
@@ -72,5 +94,209 @@ TEST(NegaScoutGumbel, SeedIsReproducible) {
             negascout_gumbel(board, 3, 4, 5678, callback));
 }
 
+TEST(NegaScout, BuiltinEvaluatorMatchesNegaEval) {
+  const auto callback = [](int, SearchResult) { return true; };
+  std::mt19937 random(1);
+  BuiltinEvaluator<BlokusDuoStandard> standard_evaluator;
+  BuiltinEvaluator<BlokusDuoMini> mini_evaluator;
+  standard::Board standard_board;
+  mini::Board mini_board;
+  for (int turn = 0; turn < 12; turn++) {
+    SCOPED_TRACE(testing::Message() << "turn=" << turn);
+    EXPECT_EQ(negascout(standard_board, 3, callback),
+              negascout(standard_board, 3, callback, {&standard_evaluator}));
+    EXPECT_EQ(negascout(mini_board, 4, callback),
+              negascout(mini_board, 4, callback, {&mini_evaluator}));
+    const auto standard_moves = standard_board.valid_moves();
+    standard_board.play_move(
+        standard_moves[random() % standard_moves.size()]);
+    const auto mini_moves = mini_board.valid_moves();
+    if (!mini_board.is_game_over())
+      mini_board.play_move(mini_moves[random() % mini_moves.size()]);
+  }
+}
+
+TEST(NegaScout, WithoutProbCutMatchesNegamax) {
+  // ProbCut is active for the Standard game up to turn 24, after the turns in
+  // which move_filter() drops small pieces.
+  const auto callback = [](int, SearchResult) { return true; };
+  std::mt19937 random(2);
+  standard::Board board;
+  while (board.turn() < 24) {
+    const auto moves = board.valid_moves();
+    board.play_move(moves[random() % moves.size()]);
+    if (board.turn() < 16) continue;
+    SCOPED_TRACE(testing::Message() << "turn=" << board.turn());
+    EXPECT_EQ(negamax(board, 3),
+              negascout(board, 3, callback, {.probcut = false}).second);
+  }
+}
+
+TEST(NegaScout, LazyEvalRarelyMisjudges) {
+  const auto callback = [](int, SearchResult) { return true; };
+  std::mt19937 random(4);
+  LazyEvalStats stats;
+  standard::Board board;
+  while (board.turn() < 24) {
+    negascout(board, 3, callback,
+              {.lazy_eval = true, .lazy_eval_stats = &stats});
+    const auto moves = board.valid_moves();
+    board.play_move(moves[random() % moves.size()]);
+  }
+  EXPECT_GT(stats.shortcuts, 0);
+  EXPECT_LE(stats.wrong * 100, stats.shortcuts);
+
+  LazyEvalStats disabled;
+  negascout(board, 3, callback, {.lazy_eval_stats = &disabled});
+  EXPECT_EQ(0, disabled.shortcuts);
+}
+
+TEST(NegaScout, SymmetryKeepsValue) {
+  const auto check = [](const auto& board, int depth) {
+    const auto callback = [](int, SearchResult) { return true; };
+    ASSERT_TRUE(board.transposed_key() == board.key());
+    const SearchResult result = negascout(board, depth, callback);
+    EXPECT_EQ(negascout(board, depth, callback, {.symmetry = false}).second,
+              result.second);
+    EXPECT_TRUE(board.is_valid_move(result.first));
+  };
+  // The empty board, and the board after a monomino on the starting point.
+  mini::Board mini_board;
+  standard::Board standard_board;
+  check(mini_board, 4);
+  check(standard_board, 3);
+  ASSERT_TRUE(mini_board.is_valid_move(Move("33a0")));
+  ASSERT_TRUE(standard_board.is_valid_move(Move("55a0")));
+  mini_board.play_move(Move("33a0"));
+  standard_board.play_move(Move("55a0"));
+  check(mini_board, 4);
+  check(standard_board, 3);
+}
+
+TEST(NegaScout, ReductionsVisitFewerNodes) {
+  const auto callback = [](int, SearchResult) { return true; };
+  const auto count_nodes =
+      [&](const standard::Board& board,
+          const SearchOptions<BlokusDuoStandard>& options) {
+        visited_nodes = 0;
+        const SearchResult result = negascout(board, 5, callback, options);
+        EXPECT_TRUE(board.is_valid_move(result.first));
+        return visited_nodes;
+      };
+  std::mt19937 random(5);
+  standard::Board board;
+  long full = 0, reduced = 0, multi_cut = 0;
+  while (board.turn() < 16) {
+    const auto moves = board.valid_moves();
+    board.play_move(moves[random() % moves.size()]);
+    if (board.turn() % 4 != 0) continue;
+    SCOPED_TRACE(testing::Message() << "turn=" << board.turn());
+    full += count_nodes(board, {});
+    reduced += count_nodes(board, {.lmr_moves = 4});
+    multi_cut += count_nodes(board, {.multi_cut = true});
+  }
+  EXPECT_LT(reduced, full);
+  EXPECT_LT(multi_cut, full);
+}
+
+TEST(NegaScout, TranspositionCutoffsKeepValue) {
+  const auto callback = [](int, SearchResult) { return true; };
+  std::mt19937 random(6);
+  EtcStats stats;
+  for (int game = 0; game < 4; game++) {
+    mini::Board board;
+    while (board.turn() < 4) {
+      SCOPED_TRACE(testing::Message() << "turn=" << board.turn());
+      EXPECT_EQ(negascout(board, 5, callback).second,
+                negascout(board, 5, callback,
+                          {.etc = true, .etc_stats = &stats})
+                    .second);
+      const auto moves = board.valid_moves();
+      board.play_move(moves[random() % moves.size()]);
+    }
+  }
+  ASSERT_EQ(stats.nodes.size(), stats.cutoffs.size());
+  ASSERT_GE(stats.nodes.size(), 4u);
+  EXPECT_GT(stats.nodes[3], 0);
+  EXPECT_GT(stats.cutoffs[3], 0);
+}
+
+TEST(Endgame, MatchesAlphaBeta) {
+  std::mt19937 random(3);
+  for (int game = 0; game < 20; game++) {
+    mini::Board board;
+    while (board.turn() < 6) {
+      const auto moves = board.valid_moves();
+      board.play_move(moves[random() % moves.size()]);
+    }
+    for (; !board.is_game_over(); board = board.child(perfect(board).first)) {
+      SCOPED_TRACE(testing::Message() << board.to_string());
+      const int expected = final_score(board, -INT_MAX, INT_MAX);
+      for (int flags = 0; flags < 8; flags++) {
+        const EndgameOptions options = {.capacity_bounds = (flags & 1) != 0,
+                                        .split_regions = (flags & 2) != 0,
+                                        .single_player = (flags & 4) != 0};
+        EXPECT_EQ(expected, perfect(board, options).second);
+        const int outcome = wld(board, options).second;
+        EXPECT_EQ((expected > 0) - (expected < 0),
+                  (outcome > 0) - (outcome < 0));
+      }
+    }
+  }
+}
+
+TEST(Endgame, GivesUpAfterTimeLimit) {
+  mini::Board board;
+  for (const char* code : {"33a0", "66a0"}) {
+    ASSERT_TRUE(board.is_valid_move(Move(code)));
+    board.play_move(Move(code));
+  }
+  EXPECT_FALSE(wld(board, {.seconds = 1e-6}).first.is_valid());
+  EXPECT_FALSE(perfect(board, {.seconds = 1e-6}).first.is_valid());
+}
+
+template <class Game>
+long tree_size(const BoardImpl<Game>& board) {
+  if (board.is_game_over()) return 1;
+  long size = 1;
+  for (Move move : board.valid_moves()) size += tree_size(board.child(move));
+  return size;
+}
+
+TEST(AutoSearch, EstimatesTreeSize) {
+  std::mt19937 random(7);
+  for (int game = 0; game < 4; game++) {
+    mini::Board board;
+    while (board.turn() < 8 && !board.is_game_over()) {
+      const auto moves = board.valid_moves();
+      board.play_move(moves[random() % moves.size()]);
+    }
+    SCOPED_TRACE(testing::Message() << board.to_string());
+    const double estimate = estimate_tree_size(board, 1000, game);
+    const long size = tree_size(board);
+    EXPECT_GT(estimate, size / 2.0);
+    EXPECT_LT(estimate, size * 2.0);
+  }
+}
+
+TEST(AutoSearch, ChoosesSearchByPredictedTime) {
+  AutoSearchInfo info;
+  mini::Board board;
+  SearchResult result = auto_search(board, {.seconds = 0.01, .info = &info});
+  EXPECT_EQ(SearchKind::NEGASCOUT, info.kind);
+  EXPECT_GT(info.perfect_seconds, info.wld_seconds);
+  EXPECT_TRUE(board.is_valid_move(result.first));
+
+  std::mt19937 random(8);
+  while (board.turn() < 8) {
+    const auto moves = board.valid_moves();
+    board.play_move(moves[random() % moves.size()]);
+  }
+  result = auto_search(board, {.seconds = 10, .info = &info});
+  EXPECT_EQ(SearchKind::PERFECT, info.kind);
+  EXPECT_FALSE(info.fell_back);
+  EXPECT_EQ(perfect(board).second, result.second);
+}
+
 }  // namespace
 }  // namespace blokusduo::search
@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "blokusduo.h"
+#include "blokusduo_record.h"
+#include "search_move.h"
+
+namespace blokusduo {
+namespace {
+
+struct Options {
+  bool mini = false;
+  int games = 16;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  double min_temperature = 1.0;
+  double max_temperature = 1.0;
+  uint64_t seed = 1;
+  std::string output = "selfplay.txt";
+};
+
+struct GameRecord {
+  uint64_t seed;
+  double temperature;
+  // With the mover's search value.
+  std::vector<search::SearchResult> moves = {};
+  int score[2] = {};
+  long nodes = 0;
+};
+
+template <class Game>
+GameRecord play_game(uint64_t seed, const Options& options) {
+  std::mt19937_64 random(seed);
+  std::uniform_real_distribution<double> temperature(options.min_temperature,
+                                                     options.max_temperature);
+  GameRecord record{seed, temperature(random)};
+  search::visited_nodes = 0;
+
+  BoardImpl<Game> board;
+  while (!board.is_game_over()) {
+    const search::SearchResult result = search::search_move(
+        board, record.temperature, search::mix_seed(seed + board.turn()));
+    record.moves.push_back(result);
+    board.play_move(result.first);
+  }
+  record.score[0] = board.score(0);
+  record.score[1] = board.score(1);
+  record.nodes = search::visited_nodes;
+  return record;
+}
+
+// Writes one line per game:
+//   <seed> <temperature> <violet score> <orange score> <move>:<value> ...
+void write_record(FILE* fp, const GameRecord& record) {
+  fprintf(fp, "%016llx %.3f %d %d", (unsigned long long)record.seed,
+          record.temperature, record.score[0], record.score[1]);
+  for (const auto& [move, value] : record.moves)
+    fprintf(fp, " %s:%d", move.code().c_str(), value);
+  fprintf(fp, "\n");
+  fflush(fp);
+}
+
+template <class Game>
+void write_record(record::Writer* writer, const GameRecord& game) {
+  record::GameRecord r;
+  r.variant = record::variant_of<Game>;
+  r.seed = game.seed;
+  r.temperature = game.temperature;
+  r.score[0] = game.score[0];
+  r.score[1] = game.score[1];
+  for (const auto& [move, value] : game.moves) {
+    r.moves.push_back(move);
+    r.values.push_back(value);
+  }
+  writer->write(r);
+}
+
+bool ends_with(const std::string& s, const char* suffix) {
+  const size_t n = strlen(suffix);
+  return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+template <class Game>
+int run(const Options& options) {
+  // Binary records are appended to; text output replaces the file.
+  std::unique_ptr<record::Writer> writer;
+  FILE* fp = nullptr;
+  if (ends_with(options.output, ".bdgr")) {
+    writer = std::make_unique<record::Writer>(options.output);
+    if (!writer->ok()) {
+      perror(options.output.c_str());
+      return 1;
+    }
+  } else if (!(fp = fopen(options.output.c_str(), "w"))) {
+    perror(options.output.c_str());
+    return 1;
+  }
+
+  std::atomic<int> next_game = 0;
+  std::mutex mutex;  // Guards the output file and the totals below.
+  int finished = 0;
+  long total_moves = 0, total_nodes = 0;
+  const auto start = std::chrono::steady_clock::now();
+
+  const auto worker = [&] {
+    for (int i; (i = next_game++) < options.games;) {
+      const GameRecord record =
+          play_game<Game>(search::mix_seed(options.seed + i), options);
+      std::lock_guard<std::mutex> lock(mutex);
+      if (writer)
+        write_record<Game>(writer.get(), record);
+      else
+        write_record(fp, record);
+      finished++;
+      total_moves += record.moves.size();
+      total_nodes += record.nodes;
+      const std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      fprintf(stderr, "%d/%d games, %.1f games/sec, %.0f moves/sec\n",
+              finished, options.games, finished / elapsed.count(),
+              total_moves / elapsed.count());
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < options.threads; i++) threads.emplace_back(worker);
+  for (std::thread& thread : threads) thread.join();
+  if (writer) {
+    writer->flush();
+    if (!writer->ok()) {
+      perror(options.output.c_str());
+      return 1;
+    }
+  } else {
+    fclose(fp);
+  }
+
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  fprintf(stderr,
+          "%d games, %ld moves, %ld nodes in %.3f sec with %d threads\n"
+          "%.2f games/sec, %.0f moves/sec, %.0f nodes/sec\n",
+          finished, total_moves, total_nodes, elapsed.count(),
+          options.threads, finished / elapsed.count(),
+          total_moves / elapsed.count(), total_nodes / elapsed.count());
+  return 0;
+}
+
+void usage(const char* program) {
+  fprintf(stderr,
+          "Usage: %s [--mini] [--games N] [--threads N]\n"
+          "          [--temperature T | --temperature MIN:MAX] [--seed S]\n"
+          "          [--output FILE]\n"
+          "Writes binary game records if FILE ends with .bdgr, and one line\n"
+          "of text per game otherwise.\n",
+          program);
+  exit(2);
+}
+
+Options parse_options(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (strcmp(arg, "--mini") == 0) {
+      options.mini = true;
+      continue;
+    }
+    if (i + 1 >= argc) usage(argv[0]);
+    const char* value = argv[++i];
+    if (strcmp(arg, "--games") == 0) {
+      options.games = atoi(value);
+    } else if (strcmp(arg, "--threads") == 0) {
+      options.threads = std::max(1, atoi(value));
+    } else if (strcmp(arg, "--temperature") == 0) {
+      char* end;
+      options.min_temperature = options.max_temperature = strtod(value, &end);
+      if (*end == ':') options.max_temperature = strtod(end + 1, &end);
+      if (*end != '\0' || options.min_temperature < 0 ||
+          options.max_temperature < options.min_temperature)
+        usage(argv[0]);
+    } else if (strcmp(arg, "--seed") == 0) {
+      options.seed = strtoull(value, nullptr, 0);
+    } else if (strcmp(arg, "--output") == 0) {
+      options.output = value;
+    } else {
+      usage(argv[0]);
+    }
+  }
+  return options;
+}
+
+}  // namespace
+}  // namespace blokusduo
+
+int main(int argc, char** argv) {
+  const blokusduo::Options options = blokusduo::parse_options(argc, argv);
+  if (options.mini) return blokusduo::run<blokusduo::BlokusDuoMini>(options);
+  return blokusduo::run<blokusduo::BlokusDuoStandard>(options);
+}